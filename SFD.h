@@ -1,47 +1,38 @@
+#include "hashTable.h"
+
 #define MAX_LINE 1024
 #define NO_FREE_RANK 1000000
 #define TRUE 1
 #define FALSE 0
 #define FAIL -1
 
-typedef struct _rank *RankNode;
-typedef struct _rank {
-    double rank_no;
-    RankNode next;
-    RankNode prev;
-}rank;
-
-typedef struct _rankList *RankList;
-typedef struct _rankList {
-    RankNode head;
-    int length;
-}ranklist;
-
 typedef struct _URLnode *SFDURLNode;
 typedef struct _URLList *SFDURLList;
 typedef struct _URLList {
     SFDURLNode head;
     int length;
+    HashTable URLs;                 //URL -> index of its node in nodes[]
+    SFDURLNode nodes;               //every node, contiguous
+    double *rankArena;              //every rank, contiguous and grouped by URL
+    double *prefixArena;            //every node's rank prefix sums, contiguous
 } SFDurllist;
 
 typedef struct _URLnode {
     char *URL;
     SFDURLNode next;
-    RankList ranks;
+    double *ranks;                  //this URLs scaled ranks in non-decreasing order (points into rankArena)
+    double *rankSums;               //rankSums[i] = ranks[0] + ... + ranks[i-1], nRanks + 1 entries (points into prefixArena)
+    int nRanks;
 } SFDurlnode;
 
-void checkMinimum(SFDURLNode *bestRanks, SFDURLNode *workingRanks, double *barSFD, int mover, int listLength);
-void swap(SFDURLNode *list, int x, int y);
-void checkSFD(SFDURLNode *bestRanks, SFDURLNode *workingRanks, int totalURLs, double *barSFD);
-SFDURLNode newSFDURLNode(SFDURLList uList, char *URL, int URLs_total, int URL_rank);
-SFDURLList newSFDURLList();
-void addRank(RankList ranks, int URLs_total, int URL_rank);
-RankList newRankList();
+double exactRanking(SFDURLNode bestRanks[], SFDURLList uList);
+SFDURLList loadRankFiles(int nFiles, char *fileNames[]);
 double calculateSFD(SFDURLNode node, int givenRank, int totalURLs);
-int barRanking(SFDURLNode bestRanks[], SFDURLList uList);
+void barRanking(SFDURLNode bestRanks[], SFDURLList uList);
 void FindSFDRank(SFDURLNode bestRanks[], SFDURLList uList, SFDURLNode curr, int chosenRank[], SFDURLNode leftChanges[], SFDURLNode rightChanges[]);
 int searchLeft(SFDURLNode ranks[], int listLength, SFDURLNode currNode, int chosenRank, 
     SFDURLNode changes[], double *leftSFDinc);
 int searchRight(SFDURLNode ranks[], int listLength, SFDURLNode currNode, int chosenRank, 
     SFDURLNode changes[], double *rightSFDinc, double leftSFDinc);
-void freeSFDURLList(SFDURLList l);
\ No newline at end of file
+void freeSFDURLList(SFDURLList l);
+void medianTopK(int nFiles, char *fileNames[], int k);
\ No newline at end of file
@@ -10,107 +10,100 @@
 #include <assert.h>
 #include "SFD.h"
 
-//Each URL ranked is stored in a linked list
-SFDURLNode newSFDURLNode(SFDURLList uList, char *URL, int URLs_total, int URL_rank) {
-    if (uList->head) {
-        for (SFDURLNode curr = uList->head; curr; curr = curr->next) {                  //time complexity = num of unique URLs already read from rankfiles = O(U)
-            if (strcmp(curr->URL, URL) == 0) {                                       //if a node already exists for a given URL, just add the new rank to that node.
-                addRank(curr->ranks, URLs_total, URL_rank);
-                return uList->head;
-            }
-        }
-    }
+#define MIN_ENTRIES 1024
 
-    SFDURLNode new = malloc(sizeof(SFDURLNode));
-    assert(new);
+static int compareRanks(const void *, const void *);
 
-    new->URL = calloc(strlen(URL) , sizeof(char));
-    assert(new->URL);
-    strcpy(new->URL, URL);
+/*
+Reads every rankfile once, in order. Each URL is given a dense index the first time it is seen (hashed, so O(1) per rank line)
+and every rank read is appended to one flat entry array. A rankfile's ranks can only be scaled once its last line has been read,
+so its entries are scaled in place as soon as the file ends. time complexity = total number of ranks across all rankfiles = O(R)
 
-    new->ranks = newRankList();
-    addRank(new->ranks, URLs_total, URL_rank);                                      //first rank of new URL node added
-    new->next = uList->head;
-    uList->length += 1;
-    return new;
-}
+Once every file is read the entries are grouped by URL with a counting sort into one contiguous rank arena, so each node ends up
+with its own sorted array of ranks and the whole list costs a handful of allocations rather than one per node and per rank.
+The prefix sums of each node's ranks are then precomputed so calculateSFD can answer any position with a binary search.
+*/
+SFDURLList loadRankFiles(int nFiles, char *fileNames[]) {
+    char buffer[MAX_LINE] = {0};
+    int nEntries = 0, maxEntries = MIN_ENTRIES;
+    int *entryURL = malloc(maxEntries * sizeof(int));                               //index of the URL each rank belongs to
+    double *entryRank = malloc(maxEntries * sizeof(double));
+    assert(entryURL && entryRank);
 
-//Adds a rank for a URL from a rankfile to a pre-existing SFDURLNode
-void addRank(RankList ranks, int URLs_total, int URL_rank) {
-    RankNode new = malloc(sizeof(rank));
-    assert(new);
+    SFDURLList uList = malloc(sizeof(SFDurllist));
+    assert(uList);
+    uList->URLs = newHashTable(MIN_ENTRIES);
 
-    new->rank_no = (double)URL_rank / URLs_total;
-    new->next = NULL;
-    new->prev = NULL;
-    RankNode curr = NULL;
+    for (int i = 0; i < nFiles; i++) {
+        FILE *fp = fopen(fileNames[i], "r"); assert(fp);
+        int fileStart = nEntries, URLRank = 0;
 
-    if (!ranks->head) {
-        ranks->head = new;
-    } 
-    else {
-        for (curr = ranks->head; curr; curr = curr->next) {              //ranks are entered in SFDURLNode in non-decreasing order so the middlemost rank value(s) can be found easily later.
-            if (new->rank_no <= curr->rank_no) {                                 //time complexity = number of ranks for that URL squared = O(urlRanks^2)
-                if (curr == ranks->head) {
-                    new->next = curr;
-                    curr->prev = new;
-                    ranks->head = new;
-                    break;
-                } 
-                else {
-                    curr->prev->next = new;
-                    new->prev = curr->prev;
-                    curr->prev = new;
-                    new->next = curr;
-                    break;
-                }
+        while (fgets(buffer, MAX_LINE, fp)) {
+            URLRank++;                                                              //every line counts towards the rankfile's length, as before
+            char *token = strtok(buffer, " \n");
+            if (!token) continue;
+            if (nEntries == maxEntries) {
+                maxEntries *= 2;
+                entryURL = realloc(entryURL, maxEntries * sizeof(int));
+                entryRank = realloc(entryRank, maxEntries * sizeof(double));
+                assert(entryURL && entryRank);
             }
-            if (!curr->next) {
-                new->prev = curr;
-                curr->next = new;
-                break;
-            } 
+            entryURL[nEntries] = getID(uList->URLs, token);
+            entryRank[nEntries++] = URLRank;
         }
-        
+        for (int e = fileStart; e < nEntries; e++) entryRank[e] /= URLRank;        //URLRank is now the number of URLs in the file
+        fclose(fp);
     }
-    ranks->length += 1;
-}
 
+    int nURLs = nKeys(uList->URLs);
+    uList->length = nURLs;
+    uList->nodes = calloc(nURLs > 0 ? nURLs : 1, sizeof(SFDurlnode));
+    uList->rankArena = malloc((nEntries > 0 ? nEntries : 1) * sizeof(double));
+    uList->prefixArena = malloc((nEntries + nURLs + 1) * sizeof(double));
+    assert(uList->nodes && uList->rankArena && uList->prefixArena);
 
-//RankList within a SFDURLNode used to store all ranks for that node.
-RankList newRankList() {
-    RankList new = malloc(sizeof(ranklist));
-    assert(new);
-    new->head = NULL;
-    new->length = 0;
-    return new;
+    for (int e = 0; e < nEntries; e++) uList->nodes[entryURL[e]].nRanks++;
+    double *arenaPos = uList->rankArena;
+    for (int u = 0; u < nURLs; u++) {
+        SFDURLNode node = &uList->nodes[u];
+        node->URL = keyOf(uList->URLs, u);
+        node->ranks = arenaPos;
+        arenaPos += node->nRanks;
+        node->nRanks = 0;                                                           //recounted as the ranks are placed below
+        node->next = u > 0 ? &uList->nodes[u - 1] : NULL;                           //most recently seen URL first, as the list was always built by prepending
+    }
+    for (int e = 0; e < nEntries; e++) {
+        SFDURLNode node = &uList->nodes[entryURL[e]];
+        node->ranks[node->nRanks++] = entryRank[e];
+    }
+    double *prefixPos = uList->prefixArena;
+    for (int u = 0; u < nURLs; u++) {                                               //ranks are kept in non-decreasing order so the middlemost rank value(s) can be found easily later.
+        SFDURLNode node = &uList->nodes[u];
+        qsort(node->ranks, node->nRanks, sizeof(double), compareRanks);
+        node->rankSums = prefixPos;
+        prefixPos += node->nRanks + 1;
+        node->rankSums[0] = 0;
+        for (int i = 0; i < node->nRanks; i++) node->rankSums[i + 1] = node->rankSums[i] + node->ranks[i];
+    }
+    uList->head = nURLs > 0 ? &uList->nodes[nURLs - 1] : NULL;
+
+    free(entryURL);
+    free(entryRank);
+    return uList;
 }
 
 
-//List of all SFDURLNodes
-SFDURLList newSFDURLList() {
-    SFDURLList new = malloc(sizeof(SFDURLList));
-    assert(new);
-    new->length = 0;
-    new->head = NULL;
-    return new;
+static int compareRanks(const void *element1, const void *element2) {
+    double rank1 = *(double *)element1, rank2 = *(double *)element2;
+    return (rank1 > rank2) - (rank1 < rank2);
 }
 
 
 //Frees SFDURLList and all associated allocated memory
 void freeSFDURLList(SFDURLList l) {
-    SFDURLNode uNode = l->head;
-    while (uNode) {
-        RankNode rNode = uNode->ranks->head;
-        while (rNode){
-            RankNode rPrev = rNode;
-            rNode = rNode->next;
-            free(rPrev);
-        }
-        free(uNode->ranks);
-        SFDURLNode uPrev = uNode;
-        uNode = uNode->next;
-        free(uPrev);    
-    }
+    free(l->nodes);
+    free(l->rankArena);
+    free(l->prefixArena);
+    disposeHashTable(l->URLs);
     free(l);
 }
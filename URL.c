@@ -7,7 +7,6 @@
 #include <stdio.h>
 #include <assert.h>
 #include "URL.h"
-#include "set.h"
 
 URLQueue newURLQueue() {
 	URLQueue new = malloc(sizeof(struct _URLqueue));
@@ -29,6 +28,7 @@ void newURLNode(char *str, URLQueue q) {
 	new->rankScore = NOT_SET;
 	new->tf = NOT_SET;
 	new->termMatches = NOT_SET;
+	new->docID = NOT_FOUND;
 	new->next = NULL;
 
 	if (!q->head) {
@@ -45,23 +45,23 @@ void newURLNode(char *str, URLQueue q) {
 //Go through collection.txt and create a queue from the urls inside
 URLQueue getURLS() {
 	URLQueue q = newURLQueue(); //the final queue containing the unique URLs in collection.txt
-	Set seenURLs = newSet();
+	HashTable seenURLs = newHashTable(1024);
 	FILE *fp = fopen("collection.txt" , "r"); assert(fp);
 	char buffer[MAX_LINE] = {0};
 
 	while (fgets(buffer, MAX_LINE, fp)) {
-		char *token = strtok(buffer, " \n"); //(explained in detail in pagerank.c)
+		char *rest, *token = strtok_r(buffer, " \n", &rest); //(explained in detail in pagerank.c)
 		while (token) {
-			if (!isElem(seenURLs, token)) { //prevent queue from having duplicate URLs
+			if (findID(seenURLs, token) == NOT_FOUND) { //prevent queue from having duplicate URLs
 				newURLNode(token, q);
-				insertInto(seenURLs, token);
+				getID(seenURLs, token);
 			}
-			token = strtok(NULL, " \n");
+			token = strtok_r(NULL, " \n", &rest);
 		}
 	}
 
 	fclose(fp);
-	disposeSet(seenURLs);
+	disposeHashTable(seenURLs);
 	return q;
 }
 
@@ -76,3 +76,10 @@ void freeURLQueue(URLQueue q) {
     }
     free(q);
 }
+
+//Gives every url in the queue a document ID, its place in the queue (so for getURLS, its place in collection.txt)
+HashTable getURLIDs(URLQueue q) {
+	HashTable ids = newHashTable(q->len);
+	for (URLNode curr = q->head; curr; curr = curr->next) getID(ids, curr->URL);
+	return ids;
+}
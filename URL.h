@@ -2,10 +2,14 @@
 #define URL_H
 
 #include <string.h>
+#include "hashTable.h"
 #define strEQ(g,t) (strcmp((g),(t)) == 0) //copied here from Graph.c for cross-file use
 #define MAX_LINE 1024
 #define MAX_URL 20
 #define NOT_SET 0
+#define SCORE_TABLE "pagerankScores.bin" //pageranks by document ID, written by pagerank alongside pagerankList.txt
+#define SCORE_TABLE_MAGIC 0x50525332 //"PRS2"
+#define SCORE_TABLE_HEADER (2*sizeof(int) + 2*sizeof(long long)) //magic, number of urls, then collection.txt's size and modification time (ns)
 
 typedef struct _URLnode *URLNode;
 
@@ -14,6 +18,7 @@ typedef struct _URLnode {
 	double tf; //separate to rankScore because rankScore needs to be aggregate using this as part of the calculation
 	double rankScore;
 	int termMatches; //number of times a URL has matched a set of search terms
+	int docID; //the URL's place in collection.txt when it came from the binary index, otherwise NOT_FOUND
 	URLNode next;
 } urlnode ;
 
@@ -29,5 +34,6 @@ URLQueue newURLQueue();
 void newURLNode(char*,URLQueue);
 URLQueue getURLS();
 void freeURLQueue(URLQueue q);
+HashTable getURLIDs(URLQueue);
 
 #endif
\ No newline at end of file
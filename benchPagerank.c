@@ -0,0 +1,195 @@
+//Times the PageRank iteration engine on a synthetic power-law link graph
+//Usage: benchPagerank threads|solvers|orderings|kernels [vertices] [avgOutLinks] [maxThreads]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <assert.h>
+#include "pagerank.h"
+
+#define DEFAULT_VERTICES 1000000
+#define DEFAULT_OUT_LINKS 10
+#define BENCH_ITERATIONS 20
+#define DAMPENING 0.85
+#define MIN_DIFF 0.00001
+#define MAX_ITERATIONS 1000
+
+static double now() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec/1e9;
+}
+
+/*
+Sources are uniform but destinations are drawn from a power law (a few pages get most of the inlinks, like a real crawl).
+Vertex IDs are shuffled so the heavily linked pages are spread through the ID space rather than bunched at the start.
+*/
+static SparseGraph syntheticGraph(int nV, int avgOutLinks) {
+	char name[32];
+	HashTable names = newHashTable(nV);
+	for (int v = 0; v < nV; v++) {
+		sprintf(name, "url%d", v);
+		getID(names, name);
+	}
+	int *shuffle = malloc(nV*sizeof(int)); assert(shuffle);
+	for (int v = 0; v < nV; v++) shuffle[v] = v;
+	for (int v = nV-1; v > 0; v--) {
+		int j = rand() % (v+1), temp = shuffle[v];
+		shuffle[v] = shuffle[j]; shuffle[j] = temp;
+	}
+
+	int nE = nV*avgOutLinks;
+	int *src = malloc(nE*sizeof(int)), *dest = malloc(nE*sizeof(int)); assert(src && dest);
+	for (int e = 0; e < nE; e++) {
+		src[e] = rand() % nV;
+		dest[e] = shuffle[(int)(nV*pow((double)rand()/((double)RAND_MAX+1), 3))];
+		if (dest[e] == src[e]) dest[e] = (dest[e]+1) % nV;
+	}
+	SparseGraph g = newSparseGraph(names, nE, src, dest);
+	free(src); free(dest); free(shuffle);
+	return g;
+}
+
+//Speedup of the parallel loop going from 1 to maxThreads threads, checking every thread count gives the same pageranks
+static void benchThreads(LinkWeights w, int maxThreads) {
+	double *pageRanks = malloc(w->nV*sizeof(double)), *firstRanks = malloc(w->nV*sizeof(double));
+	assert(pageRanks && firstRanks);
+	double oneThread = 0;
+	printf("%d iterations\n%8s %10s %10s %10s\n", BENCH_ITERATIONS, "threads", "seconds", "speedup", "identical");
+	for (int t = 1; t <= maxThreads; t++) {
+		for (int i = 0; i < w->nV; i++) pageRanks[i] = (double)1/w->nV;
+		double start = now();
+		iteratePageRankParallel(w, DAMPENING, 0, BENCH_ITERATIONS, pageRanks, t);
+		double elapsed = now() - start;
+		if (t == 1) {
+			oneThread = elapsed;
+			memcpy(firstRanks, pageRanks, w->nV*sizeof(double));
+		}
+		printf("%8d %10.3f %10.2f %10s\n", t, elapsed, oneThread/elapsed, memcmp(firstRanks, pageRanks, w->nV*sizeof(double)) == 0 ? "yes" : "NO");
+	}
+	free(pageRanks); free(firstRanks);
+}
+
+//Iterations and edges each solver needs to get down to MIN_DIFF, and how far each ends up from a fully converged answer
+static void benchSolvers(LinkWeights w) {
+	double *exact = malloc(w->nV*sizeof(double)), *pageRanks = malloc(w->nV*sizeof(double));
+	assert(exact && pageRanks);
+	for (int i = 0; i < w->nV; i++) exact[i] = (double)1/w->nV;
+	iteratePageRankGaussSeidel(w, DAMPENING, 1e-15, MAX_ITERATIONS, exact);
+
+	char *names[] = { "jacobi", "gs", "push" };
+	printf("%8s %10s %14s %10s %14s\n", "solver", "iterations", "edges", "seconds", "L1 error");
+	for (SolverType solver = Jacobi; solver <= Push; solver++) {
+		for (int i = 0; i < w->nV; i++) pageRanks[i] = (double)1/w->nV;
+		double start = now();
+		SolverStats stats;
+		if (solver == Jacobi) stats = iteratePageRank(w, DAMPENING, MIN_DIFF, MAX_ITERATIONS, pageRanks);
+		else if (solver == GaussSeidel) stats = iteratePageRankGaussSeidel(w, DAMPENING, MIN_DIFF, MAX_ITERATIONS, pageRanks);
+		else stats = iteratePageRankPush(w, DAMPENING, MIN_DIFF, MAX_ITERATIONS, pageRanks, NULL);
+		double elapsed = now() - start, error = 0;
+		for (int i = 0; i < w->nV; i++) error += fabs(pageRanks[i] - exact[i]);
+		printf("%8s %10d %14ld %10.3f %14.3e\n", names[solver], stats.iterations, stats.edges, elapsed, error);
+	}
+	free(exact); free(pageRanks);
+}
+
+//Counts hardware cache misses for this thread, or returns -1 if the kernel won't let us (no PMU in a VM, perf_event_paranoid)
+static int openCacheMissCounter() {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = PERF_COUNT_HW_CACHE_MISSES;
+	attr.disabled = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+//Iteration time and cache misses of the jacobi loop with the vertices in their shuffled order and under each reordering
+static void benchOrderings(SparseGraph g) {
+	char *names[] = { "none", "degree", "bfs", "rcm" };
+	int counter = openCacheMissCounter();
+	printf("%d iterations%s\n%8s %10s %10s %16s\n", BENCH_ITERATIONS, counter == -1 ? ", cache misses not available" : "", "ordering", "reorder s", "iterate s", "cache misses");
+	for (VertexOrder order = NoOrder; order <= RCMOrder; order++) {
+		double start = now();
+		int *newID = order == NoOrder ? NULL : findOrdering(g, order);
+		SparseGraph ordered = newID ? reorderGraph(g, newID) : g;
+		double reorderTime = now() - start;
+		LinkWeights w = newLinkWeights(ordered);
+		double *pageRanks = malloc(w->nV*sizeof(double)); assert(pageRanks);
+		for (int i = 0; i < w->nV; i++) pageRanks[i] = (double)1/w->nV;
+
+		long long misses = -1;
+		if (counter != -1) { ioctl(counter, PERF_EVENT_IOC_RESET, 0); ioctl(counter, PERF_EVENT_IOC_ENABLE, 0); }
+		start = now();
+		iteratePageRank(w, DAMPENING, 0, BENCH_ITERATIONS, pageRanks);
+		double elapsed = now() - start;
+		if (counter != -1) {
+			ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+			if (read(counter, &misses, sizeof(misses)) != sizeof(misses)) misses = -1;
+		}
+		if (misses == -1) printf("%8s %10.3f %10.3f %16s\n", names[order], reorderTime, elapsed, "n/a");
+		else printf("%8s %10.3f %10.3f %16lld\n", names[order], reorderTime, elapsed, misses);
+
+		free(pageRanks); free(newID);
+		freeLinkWeights(w);
+		if (ordered != g) disposeSparseGraph(ordered);
+	}
+	if (counter != -1) close(counter);
+}
+
+//Edges per second on one core for the reference loop and each vectorised kernel, and how far each ends up from the reference pageranks
+static void benchKernels(LinkWeights w) {
+	double *exact = malloc(w->nV*sizeof(double)), *pageRanks = malloc(w->nV*sizeof(double));
+	assert(exact && pageRanks);
+	for (int i = 0; i < w->nV; i++) exact[i] = (double)1/w->nV;
+	double start = now();
+	iteratePageRank(w, DAMPENING, 0, BENCH_ITERATIONS, exact);
+	double elapsed = now() - start;
+	printf("%d iterations, avx2 %s\n%16s %10s %14s %14s\n", BENCH_ITERATIONS, haveAVX2Kernel() ? "available" : "not available", "kernel", "seconds", "edges/sec", "L1 error");
+	printf("%16s %10.3f %14.3e %14.3e\n", "reference", elapsed, (double)BENCH_ITERATIONS*w->nE/elapsed, 0.0);
+
+	char *names[] = { "scalar double", "avx2 double", "scalar float", "avx2 float" };
+	for (int kernel = 0; kernel < 4; kernel++) {
+		int singlePrecision = kernel >= 2, useSIMD = kernel % 2;
+		if (useSIMD && !haveAVX2Kernel()) continue;
+		for (int i = 0; i < w->nV; i++) pageRanks[i] = (double)1/w->nV;
+		start = now();
+		iteratePageRankVectorised(w, DAMPENING, 0, BENCH_ITERATIONS, pageRanks, singlePrecision, useSIMD);
+		elapsed = now() - start;
+		double error = 0;
+		for (int i = 0; i < w->nV; i++) error += fabs(pageRanks[i] - exact[i]);
+		printf("%16s %10.3f %14.3e %14.3e\n", names[kernel], elapsed, (double)BENCH_ITERATIONS*w->nE/elapsed, error);
+	}
+	free(exact); free(pageRanks);
+}
+
+int main(int argc, char *argv[]) {
+	if (argc < 2 || (strcmp(argv[1], "threads") != 0 && strcmp(argv[1], "solvers") != 0 && strcmp(argv[1], "orderings") != 0 && strcmp(argv[1], "kernels") != 0)) {
+		fprintf(stderr, "Usage: benchPagerank threads|solvers|orderings|kernels [vertices] [avgOutLinks] [maxThreads]\n");
+		return 1;
+	}
+	int nV = argc > 2 ? atoi(argv[2]) : DEFAULT_VERTICES;
+	int avgOutLinks = argc > 3 ? atoi(argv[3]) : DEFAULT_OUT_LINKS;
+	int maxThreads = argc > 4 ? atoi(argv[4]) : sysconf(_SC_NPROCESSORS_ONLN);
+
+	srand(1);
+	SparseGraph g = syntheticGraph(nV, avgOutLinks);
+	LinkWeights w = newLinkWeights(g);
+	printf("%d vertices, %d edges\n", g->nV, g->nE);
+	if (strcmp(argv[1], "threads") == 0) benchThreads(w, maxThreads);
+	else if (strcmp(argv[1], "solvers") == 0) benchSolvers(w);
+	else if (strcmp(argv[1], "orderings") == 0) benchOrderings(g);
+	else benchKernels(w);
+
+	freeLinkWeights(w);
+	disposeSparseGraph(g);
+	return 0;
+}
@@ -0,0 +1,74 @@
+//Times loadRankFiles on synthetic rankfiles of doubling size to show load time grows linearly with the total number of ranks
+//Usage: benchRankLoad [nFiles] [maxURLsPerFile]
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <assert.h>
+#include "SFD.h"
+
+#define DEFAULT_FILES 8
+#define DEFAULT_MAX_URLS 200000
+#define MIN_URLS 12500
+
+static double now() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+//Each file ranks a random half of a pool of 2*nURLs URLs, so most URLs appear in several files
+static void writeRankFiles(char *fileNames[], int nFiles, int nURLs) {
+    int poolSize = 2 * nURLs;
+    int *pool = malloc(poolSize * sizeof(int)); assert(pool);
+    for (int i = 0; i < poolSize; i++) pool[i] = i;
+
+    for (int f = 0; f < nFiles; f++) {
+        for (int i = 0; i < nURLs; i++) {                                           //partial Fisher-Yates shuffle picks this file's URLs
+            int j = i + rand() % (poolSize - i);
+            int temp = pool[i]; pool[i] = pool[j]; pool[j] = temp;
+        }
+        FILE *fp = fopen(fileNames[f], "w"); assert(fp);
+        for (int i = 0; i < nURLs; i++) fprintf(fp, "url%d\n", pool[i]);
+        fclose(fp);
+    }
+    free(pool);
+}
+
+int main(int argc, char *argv[]) {
+    int nFiles = argc > 1 ? atoi(argv[1]) : DEFAULT_FILES;
+    int maxURLs = argc > 2 ? atoi(argv[2]) : DEFAULT_MAX_URLS;
+    char dir[] = "/tmp/benchRankLoadXXXXXX";
+    if (!mkdtemp(dir)) {
+        perror(dir);
+        return 1;
+    }
+
+    char **fileNames = malloc(nFiles * sizeof(char *)); assert(fileNames);
+    for (int f = 0; f < nFiles; f++) {
+        fileNames[f] = malloc(strlen(dir) + 32); assert(fileNames[f]);
+        sprintf(fileNames[f], "%s/rank%d.txt", dir, f);
+    }
+
+    srand(1);
+    printf("%10s %10s %10s %12s\n", "ranks", "URLs", "seconds", "ns/rank");
+    for (int nURLs = MIN_URLS; nURLs <= maxURLs; nURLs *= 2) {
+        writeRankFiles(fileNames, nFiles, nURLs);
+        double start = now();
+        SFDURLList uList = loadRankFiles(nFiles, fileNames);
+        double elapsed = now() - start;
+        long ranks = (long)nFiles * nURLs;
+        printf("%10ld %10d %10.4f %12.1f\n", ranks, uList->length, elapsed, elapsed * 1e9 / ranks);
+        freeSFDURLList(uList);
+    }
+
+    for (int f = 0; f < nFiles; f++) {
+        unlink(fileNames[f]);
+        free(fileNames[f]);
+    }
+    free(fileNames);
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,114 @@
+//Checks scaledFootrule's minSFD against a brute force search over every arrangement, on small random rankfiles of up to 8 URLs
+//Usage: checkSFD [trials] [scaledFootrule]
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <unistd.h>
+#include <assert.h>
+#include "SFD.h"
+
+#define DEFAULT_TRIALS 300
+#define MAX_URLS 8
+#define MAX_FILES 4
+#define TOLERANCE 1e-6
+
+//Each file ranks a random selection of 1 to nURLs of the URLs, in a random order
+static void writeRankFiles(char *fileNames[], int nFiles, int nURLs) {
+    int pool[MAX_URLS];
+    for (int i = 0; i < nURLs; i++) pool[i] = i;
+    for (int f = 0; f < nFiles; f++) {
+        int length = 1 + rand() % nURLs;
+        for (int i = 0; i < length; i++) {                                          //partial Fisher-Yates shuffle picks this file's URLs
+            int j = i + rand() % (nURLs - i);
+            int temp = pool[i]; pool[i] = pool[j]; pool[j] = temp;
+        }
+        FILE *fp = fopen(fileNames[f], "w"); assert(fp);
+        for (int i = 0; i < length; i++) fprintf(fp, "url%d\n", pool[i]);
+        fclose(fp);
+    }
+}
+
+//SFD of placing each node at position (1-based) place[i], summed straight from the ranks rather than with calculateSFD
+static double arrangementSFD(SFDURLNode nodes[], int place[], int n) {
+    double total = 0;
+    for (int i = 0; i < n; i++) {
+        for (int r = 0; r < nodes[i]->nRanks; r++) total += fabs(nodes[i]->ranks[r] - (double)place[i]/n);
+    }
+    return total;
+}
+
+//The least SFD over every arrangement of positions k..n-1 among nodes k..n-1
+static double bruteForce(SFDURLNode nodes[], int place[], int k, int n) {
+    if (k == n) return arrangementSFD(nodes, place, n);
+    double best = INFINITY;
+    for (int i = k; i < n; i++) {
+        int temp = place[k]; place[k] = place[i]; place[i] = temp;
+        double sfd = bruteForce(nodes, place, k + 1, n);
+        if (sfd < best) best = sfd;
+        temp = place[k]; place[k] = place[i]; place[i] = temp;
+    }
+    return best;
+}
+
+int main(int argc, char *argv[]) {
+    int trials = argc > 1 ? atoi(argv[1]) : DEFAULT_TRIALS;
+    char *program = argc > 2 ? argv[2] : "./scaledFootrule";
+    char dir[] = "/tmp/checkSFDXXXXXX";
+    if (!mkdtemp(dir)) {
+        perror(dir);
+        return 1;
+    }
+    char *fileNames[MAX_FILES];
+    for (int f = 0; f < MAX_FILES; f++) {
+        fileNames[f] = malloc(strlen(dir) + 32); assert(fileNames[f]);
+        sprintf(fileNames[f], "%s/rank%d.txt", dir, f);
+    }
+
+    int failures = 0;
+    for (int seed = 1; seed <= trials; seed++) {
+        srand(seed);
+        int nFiles = 2 + rand() % (MAX_FILES - 1), nURLs = 1 + rand() % MAX_URLS;
+        writeRankFiles(fileNames, nFiles, nURLs);
+        SFDURLList uList = loadRankFiles(nFiles, fileNames);
+        int n = uList->length;
+        SFDURLNode nodes[MAX_URLS];
+        int place[MAX_URLS];
+        for (int i = 0; i < n; i++) {                                               //in the order of their IDs in uList->URLs
+            nodes[i] = &uList->nodes[i];
+            place[i] = i + 1;
+        }
+        double best = bruteForce(nodes, place, 0, n);
+
+        char command[MAX_LINE], line[MAX_LINE];
+        int length = snprintf(command, MAX_LINE, "%s", program);
+        for (int f = 0; f < nFiles; f++) length += snprintf(command + length, MAX_LINE - length, " %s", fileNames[f]);
+        FILE *out = popen(command, "r");
+        double printed = NAN;
+        int position = 0;
+        if (out && fgets(line, MAX_LINE, out)) sscanf(line, "minSFD = %lf", &printed);
+        while (out && fgets(line, MAX_LINE, out) && position < n) {                 //the arrangement printed has to have the SFD printed
+            line[strcspn(line, "\n")] = '\0';
+            int id = findID(uList->URLs, line);
+            if (id == NOT_FOUND) break;
+            place[id] = ++position;
+        }
+        if (out) pclose(out);
+        double arranged = position == n ? arrangementSFD(nodes, place, n) : NAN;
+
+        if (!(fabs(printed - best) < TOLERANCE) || !(fabs(arranged - printed) < TOLERANCE)) {
+            printf("seed %d: %d URLs in %d rankfiles, printed minSFD %.6f (arrangement %.6f), brute force %.6f\n", seed, n, nFiles, printed, arranged, best);
+            failures++;
+        }
+        freeSFDURLList(uList);
+    }
+    printf("%d of %d trials wrong\n", failures, trials);
+
+    for (int f = 0; f < MAX_FILES; f++) {
+        unlink(fileNames[f]);
+        free(fileNames[f]);
+    }
+    rmdir(dir);
+    return failures > 0;
+}
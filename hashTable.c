@@ -0,0 +1,199 @@
+// hashTable.c ... Hash Table of strings (open addressing)
+// Maps each distinct string to a dense integer ID so callers can keep their per-string data in plain arrays
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include "hashTable.h"
+
+#define MIN_SLOTS 64
+#define BLOCK_SIZE 65536 // keys are copied into blocks of this many bytes so they never move once added
+
+typedef struct Block *BlockLink;
+
+typedef struct Block {
+	BlockLink next;
+	size_t used;
+	size_t size;
+	char  data[];
+} Block;
+
+typedef struct Slot {
+	unsigned hash;  // kept with the key so probing rarely needs a strcmp
+	int   id;       // NOT_FOUND if the slot is empty
+	char  *key;
+} Slot;
+
+typedef struct HashTableRep {
+	int   nKeys;
+	int   maxKeys;  // capacity of keys[]
+	int   nSlots;   // always a power of 2, at most half full
+	Slot  *slots;
+	char  **keys;   // keys[ID] is the string with that ID
+	BlockLink blocks;
+} HashTableRep;
+
+// Function signatures
+
+HashTable newHashTable(int);
+void disposeHashTable(HashTable);
+int   getID(HashTable,char *);
+int   findID(HashTable,char *);
+char *keyOf(HashTable,int);
+int   nKeys(HashTable);
+
+static unsigned hash(char *);
+static int  findSlot(HashTable,char *,unsigned);
+static void rehash(HashTable);
+static char *copyKey(HashTable,char *);
+
+
+// newHashTable(N)
+// - create an initially empty HashTable sized for about N keys
+HashTable newHashTable(int expected)
+{
+	HashTable new = malloc(sizeof(HashTableRep));
+	assert(new != NULL);
+	new->nKeys = 0;
+	new->maxKeys = expected > MIN_SLOTS ? expected : MIN_SLOTS;
+	new->nSlots = MIN_SLOTS;
+	while (new->nSlots < 2*new->maxKeys) new->nSlots *= 2;
+	new->slots = malloc(new->nSlots*sizeof(Slot));
+	new->keys = malloc(new->maxKeys*sizeof(char *));
+	assert(new->slots != NULL && new->keys != NULL);
+	for (int i = 0; i < new->nSlots; i++) new->slots[i].id = NOT_FOUND;
+	new->blocks = NULL;
+	return new;
+}
+
+// disposeHashTable(HashTable)
+// - clean up memory associated with HashTable, including every key
+void disposeHashTable(HashTable h)
+{
+	if (h == NULL) return;
+	BlockLink curr = h->blocks;
+	while (curr != NULL) {
+		BlockLink next = curr->next;
+		free(curr);
+		curr = next;
+	}
+	free(h->slots);
+	free(h->keys);
+	free(h);
+}
+
+// getID(HashTable,Str)
+// - return the ID of Str, adding Str with the next unused ID if it is not already in the table
+int getID(HashTable h, char *str)
+{
+	assert(h != NULL);
+	unsigned code = hash(str);
+	int slot = findSlot(h, str, code);
+	if (h->slots[slot].id != NOT_FOUND) return h->slots[slot].id;
+
+	if (h->nKeys == h->maxKeys) {
+		h->maxKeys *= 2;
+		h->keys = realloc(h->keys, h->maxKeys*sizeof(char *));
+		assert(h->keys != NULL);
+	}
+	if (2*(h->nKeys+1) > h->nSlots) {
+		rehash(h);
+		slot = findSlot(h, str, code);
+	}
+	int id = h->nKeys++;
+	h->keys[id] = copyKey(h, str);
+	h->slots[slot].hash = code;
+	h->slots[slot].id = id;
+	h->slots[slot].key = h->keys[id];
+	return id;
+}
+
+// findID(HashTable,Str)
+// - return the ID of Str, or NOT_FOUND if it has never been added
+int findID(HashTable h, char *str)
+{
+	assert(h != NULL);
+	return h->slots[findSlot(h, str, hash(str))].id;
+}
+
+// keyOf(HashTable,ID)
+// - return the string with the given ID (owned by the table)
+char *keyOf(HashTable h, int id)
+{
+	assert(h != NULL && id >= 0 && id < h->nKeys);
+	return h->keys[id];
+}
+
+// nKeys(HashTable)
+// - return # distinct strings in HashTable
+int nKeys(HashTable h)
+{
+	assert(h != NULL);
+	return h->nKeys;
+}
+
+// Helper functions
+
+// FNV-1a
+static unsigned hash(char *str)
+{
+	unsigned code = 2166136261u;
+	for (unsigned char *c = (unsigned char *)str; *c; c++) {
+		code ^= *c;
+		code *= 16777619u;
+	}
+	return code;
+}
+
+// findSlot(HashTable,Str,Hash)
+// - linear probe for Str, returning its slot or the empty slot where it would go
+static int findSlot(HashTable h, char *str, unsigned code)
+{
+	int mask = h->nSlots - 1;
+	int slot = code & mask;
+	while (h->slots[slot].id != NOT_FOUND) {
+		if (h->slots[slot].hash == code && strcmp(h->slots[slot].key, str) == 0) return slot;
+		slot = (slot + 1) & mask;
+	}
+	return slot;
+}
+
+// rehash(HashTable)
+// - move every key into twice as many slots
+static void rehash(HashTable h)
+{
+	int oldSlots = h->nSlots;
+	Slot *slots = h->slots;
+	h->nSlots *= 2;
+	h->slots = malloc(h->nSlots*sizeof(Slot));
+	assert(h->slots != NULL);
+	for (int i = 0; i < h->nSlots; i++) h->slots[i].id = NOT_FOUND;
+	for (int i = 0; i < oldSlots; i++) {
+		if (slots[i].id == NOT_FOUND) continue;
+		int slot = slots[i].hash & (h->nSlots - 1);
+		while (h->slots[slot].id != NOT_FOUND) slot = (slot + 1) & (h->nSlots - 1);
+		h->slots[slot] = slots[i];
+	}
+	free(slots);
+}
+
+// copyKey(HashTable,Str)
+// - copy Str into the table's current block, starting a new block when it is full
+static char *copyKey(HashTable h, char *str)
+{
+	size_t len = strlen(str) + 1;
+	if (h->blocks == NULL || h->blocks->used + len > h->blocks->size) {
+		size_t size = len > BLOCK_SIZE ? len : BLOCK_SIZE;
+		BlockLink new = malloc(sizeof(Block) + size);
+		assert(new != NULL);
+		new->used = 0;
+		new->size = size;
+		new->next = h->blocks;
+		h->blocks = new;
+	}
+	char *key = h->blocks->data + h->blocks->used;
+	memcpy(key, str, len);
+	h->blocks->used += len;
+	return key;
+}
@@ -0,0 +1,20 @@
+// hashTable.h ... interface to Hash Table of strings
+// Maps each distinct string to a dense integer ID (0, 1, 2, ...) in the order the strings were first added
+
+#ifndef HASHTABLE_H
+#define HASHTABLE_H
+
+#define NOT_FOUND -1
+
+typedef struct HashTableRep *HashTable;
+
+// Function signatures
+
+HashTable newHashTable(int);
+void disposeHashTable(HashTable);
+int   getID(HashTable,char *);
+int   findID(HashTable,char *);
+char *keyOf(HashTable,int);
+int   nKeys(HashTable);
+
+#endif
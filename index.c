@@ -0,0 +1,639 @@
+// index.c ... binary inverted index
+// Written once by inverted, then mapped into memory by the search programs so a lookup only touches the pages it needs
+// After inverted -u the index is a list of segment files named in a manifest, read together as one index
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "index.h"
+
+#define INDEX_MAGIC 0x49445832 // "IDX2"
+#define MIN_ENTRIES 1024
+#define MIN_STRINGS 65536
+#define OPEN_ATTEMPTS 3 // times to reread the manifest if a segment it names was merged away before it could be opened
+
+// File layout: the header, every term's postings back to back, the strings (urls and terms, each '\0' terminated),
+// the document table (where each url starts in the strings), each document's length in words, then the dictionary sorted by term.
+// A postings list is its document IDs in increasing order, each stored as the gap from the one before and followed by
+// the number of times the term is in that document. Both are varints: 7 bits per byte, low bits first,
+// with the top bit set on every byte but the last.
+// Document IDs are the same in every segment: each segment's document table has every url given an ID when it was written,
+// but only the documents it was written for have postings and lengths in it.
+// The manifest is text: a line "manifest <nextGen> <nDocs> <nSegments> <defaultGen>", a line "segment <gen>" for each
+// segment oldest first, then "owner <doc> <gen>" for each document whose live postings aren't in segment defaultGen
+// (gen DELETED if it has none), then "end". Postings in any other segment are masked, as if that segment didn't have the document.
+
+typedef struct IndexHeader {
+	int   magic;
+	int   nDocs;
+	int   nTerms;
+	int   unused;
+	long  totalWords;  // words in all the documents together
+	long  strings;     // file offsets of each part
+	long  docs;
+	long  lengths;
+	long  dictionary;
+	long  size;
+} IndexHeader;
+
+typedef struct Entry {
+	int   term;        // offset of the term in the strings
+	int   nPostings;
+	long  postings;    // file offset of the term's postings
+} Entry;
+
+typedef struct IndexWriterRep {
+	FILE  *fp;
+	char  *fileName;
+	char  *tmpName;    // written here and renamed to fileName when done, so a search that has the old index mapped keeps a whole file
+	long  offset;      // where the next postings go
+	int   nDocs;
+	int   *docs;
+	int   *lengths;
+	int   nEntries;
+	int   maxEntries;
+	Entry *entries;
+	int   nStrings;
+	int   maxStrings;
+	char  *strings;
+	int   lastTerm;    // offset of the last term added, to check they come in order
+} IndexWriterRep;
+
+typedef struct Part {     // one mapped index file
+	char  *base;
+	long  size;
+	IndexHeader *header;
+	char  *strings;
+	int   *docs;
+	int   *lengths;
+	Entry *dictionary;
+} Part;
+
+typedef struct IndexRep {
+	int   nParts;
+	Part  *parts;      // the segments, oldest first, or just the one file
+	Part  *table;      // the part with the biggest document table, for urls
+	int   *owner;      // owner[doc] is the part with doc's live postings, or DELETED; NULL if every document is live in parts[0]
+	int   nLive;       // documents that are live somewhere
+} IndexRep;
+
+// Function signatures
+
+IndexWriter newIndexWriter(char *,URLQueue);
+void  setDocLength(IndexWriter,int,int);
+void  addTerm(IndexWriter,char *,int,int *,int *);
+void  closeIndexWriter(IndexWriter);
+
+Index openIndex(char *);
+Index openCurrentIndex();
+Index openSegments(Manifest,int *,int);
+void  closeIndex(Index);
+int   nDocs(Index);
+int   docTableSize(Index);
+long  totalWords(Index);
+char *docURL(Index,int);
+int   docLength(Index,int);
+int   findTerm(Index,char *);
+int   firstTerm(Index);
+int   nextTerm(Index,int);
+char *termAt(Index,int);
+int   termDocs(Index,int);
+int   getPostings(Index,int,int *,int *);
+
+Manifest newManifest(int);
+Manifest readManifest(char *);
+void  writeManifest(char *,Manifest);
+void  freeManifest(Manifest);
+void  segmentFile(int,char *);
+
+static int addString(IndexWriter,char *);
+static int putVarint(unsigned char *,unsigned);
+static int mapPart(char *,Part *);
+static int searchPart(Part *,char *);
+static int decodePart(Index,int,int,int *,int *);
+static int comparePostings(const void *,const void *);
+
+
+// newIndexWriter(File,Docs)
+// - start writing an index to File, where document ID i is the i'th url in Docs
+// - File only changes when the writer is closed, when the whole new index replaces it at once
+IndexWriter newIndexWriter(char *fileName, URLQueue docs)
+{
+	IndexWriter new = malloc(sizeof(IndexWriterRep));
+	assert(new != NULL);
+	new->fileName = strdup(fileName);
+	new->tmpName = malloc(strlen(fileName) + 5);
+	assert(new->fileName != NULL && new->tmpName != NULL);
+	sprintf(new->tmpName, "%s.tmp", fileName);
+	new->fp = fopen(new->tmpName, "wb");
+	if (new->fp == NULL) {
+		perror(new->tmpName);
+		exit(1);
+	}
+	new->offset = sizeof(IndexHeader);
+	fseek(new->fp, new->offset, SEEK_SET);
+	new->nEntries = 0;
+	new->maxEntries = MIN_ENTRIES;
+	new->entries = malloc(new->maxEntries*sizeof(Entry));
+	new->nStrings = 0;
+	new->maxStrings = MIN_STRINGS;
+	new->strings = malloc(new->maxStrings);
+	new->nDocs = docs->len;
+	new->docs = malloc((docs->len > 0 ? docs->len : 1)*sizeof(int));
+	new->lengths = calloc(docs->len > 0 ? docs->len : 1, sizeof(int));
+	assert(new->entries != NULL && new->strings != NULL && new->docs != NULL && new->lengths != NULL);
+	int d = 0;
+	for (URLNode curr = docs->head; curr; curr = curr->next) new->docs[d++] = addString(new, curr->URL);
+	new->lastTerm = -1;
+	return new;
+}
+
+// setDocLength(Writer,Doc,Length)
+// - record that document ID Doc is Length words long
+void setDocLength(IndexWriter w, int doc, int length)
+{
+	assert(w != NULL && doc >= 0 && doc < w->nDocs);
+	w->lengths[doc] = length;
+}
+
+// addTerm(Writer,Term,N,Docs,Counts)
+// - add Term with the N document IDs in Docs, which must be increasing, and the number of times it is in each in Counts
+// - terms must be added in strcmp order
+void addTerm(IndexWriter w, char *term, int n, int *docs, int *counts)
+{
+	assert(w != NULL);
+	assert(w->lastTerm == -1 || strcmp(w->strings + w->lastTerm, term) < 0);
+	if (w->nEntries == w->maxEntries) {
+		w->maxEntries *= 2;
+		w->entries = realloc(w->entries, w->maxEntries*sizeof(Entry));
+		assert(w->entries != NULL);
+	}
+	Entry *e = &w->entries[w->nEntries++];
+	e->term = w->lastTerm = addString(w, term);
+	e->nPostings = n;
+	e->postings = w->offset;
+
+	unsigned char bytes[10];
+	for (int i = 0, prev = 0; i < n; prev = docs[i++]) {
+		assert(i == 0 || docs[i] > prev);
+		int nBytes = putVarint(bytes, docs[i] - prev);
+		nBytes += putVarint(bytes + nBytes, counts[i]);
+		fwrite(bytes, 1, nBytes, w->fp);
+		w->offset += nBytes;
+	}
+}
+
+// closeIndexWriter(Writer)
+// - write out the strings, document table and dictionary, then the header, rename the index into place and clean up
+void closeIndexWriter(IndexWriter w)
+{
+	assert(w != NULL);
+	IndexHeader header = { .magic = INDEX_MAGIC, .nDocs = w->nDocs, .nTerms = w->nEntries };
+	for (int d = 0; d < w->nDocs; d++) header.totalWords += w->lengths[d];
+	header.strings = w->offset;
+	fwrite(w->strings, 1, w->nStrings, w->fp);
+	header.docs = header.strings + w->nStrings;
+	header.docs += (8 - header.docs % 8) % 8; // keep the tables aligned
+	fseek(w->fp, header.docs, SEEK_SET);
+	fwrite(w->docs, sizeof(int), w->nDocs, w->fp);
+	header.lengths = header.docs + (long)w->nDocs*sizeof(int);
+	fwrite(w->lengths, sizeof(int), w->nDocs, w->fp);
+	header.dictionary = header.lengths + (long)w->nDocs*sizeof(int);
+	header.dictionary += (8 - header.dictionary % 8) % 8;
+	fseek(w->fp, header.dictionary, SEEK_SET);
+	fwrite(w->entries, sizeof(Entry), w->nEntries, w->fp);
+	header.size = header.dictionary + (long)w->nEntries*sizeof(Entry);
+	fseek(w->fp, 0, SEEK_SET);
+	fwrite(&header, sizeof(IndexHeader), 1, w->fp);
+	if (ferror(w->fp) | fclose(w->fp) || rename(w->tmpName, w->fileName) != 0) {
+		perror(w->fileName);
+		unlink(w->tmpName);
+		exit(1);
+	}
+	free(w->fileName); free(w->tmpName);
+	free(w->docs); free(w->lengths); free(w->entries); free(w->strings);
+	free(w);
+}
+
+// openIndex(File)
+// - map the index in File into memory, or return NULL if there isn't a valid one
+Index openIndex(char *fileName)
+{
+	Part part;
+	if (!mapPart(fileName, &part)) return NULL;
+	Index new = malloc(sizeof(IndexRep));
+	assert(new != NULL);
+	new->parts = malloc(sizeof(Part));
+	assert(new->parts != NULL);
+	new->nParts = 1;
+	new->parts[0] = part;
+	new->table = new->parts;
+	new->owner = NULL;
+	new->nLive = part.header->nDocs;
+	return new;
+}
+
+// openCurrentIndex()
+// - open the index as inverted last left it: the segments in INDEX_MANIFEST if it has been updated since the last full build,
+//   otherwise INDEX_FILE; NULL if there isn't a valid one
+Index openCurrentIndex()
+{
+	for (int attempt = 0; attempt < OPEN_ATTEMPTS; attempt++) {
+		Manifest m = readManifest(INDEX_MANIFEST);
+		if (m == NULL) return openIndex(INDEX_FILE);
+		Index idx = openSegments(m, m->gens, m->nSegments);
+		freeManifest(m);
+		if (idx != NULL) return idx;
+	}
+	return NULL;
+}
+
+// openSegments(Manifest,Gens,N)
+// - map the N segments with generations Gens from Manifest as one index, where a document is only live in the segment that owns it
+// - returns NULL if one of them can't be opened (it may have just been merged away)
+Index openSegments(Manifest m, int *gens, int n)
+{
+	Index new = malloc(sizeof(IndexRep));
+	assert(new != NULL);
+	new->nParts = n;
+	new->parts = malloc((n > 0 ? n : 1)*sizeof(Part));
+	new->owner = malloc((m->nDocs > 0 ? m->nDocs : 1)*sizeof(int));
+	assert(new->parts != NULL && new->owner != NULL);
+	new->table = NULL;
+	for (int p = 0; p < n; p++) {
+		char fileName[MAX_LINE];
+		segmentFile(gens[p], fileName);
+		if (!mapPart(fileName, &new->parts[p])) {
+			new->nParts = p;
+			closeIndex(new);
+			return NULL;
+		}
+		if (new->table == NULL || new->parts[p].header->nDocs > new->table->header->nDocs) new->table = &new->parts[p];
+	}
+	new->nLive = 0;
+	for (int d = 0; d < m->nDocs; d++) {
+		new->owner[d] = DELETED;
+		for (int p = 0; p < n; p++) if (m->owner[d] == gens[p]) new->owner[d] = p;
+		if (new->owner[d] != DELETED) new->nLive++;
+	}
+	return new;
+}
+
+// closeIndex(Index)
+// - unmap the index and clean up
+void closeIndex(Index idx)
+{
+	if (idx == NULL) return;
+	for (int p = 0; p < idx->nParts; p++) munmap(idx->parts[p].base, idx->parts[p].size);
+	free(idx->parts); free(idx->owner);
+	free(idx);
+}
+
+// nDocs(Index)
+// - return # documents the index was built from, less any deleted since
+int nDocs(Index idx)
+{
+	assert(idx != NULL);
+	return idx->nLive;
+}
+
+// docTableSize(Index)
+// - return # document IDs given out, deleted documents included
+int docTableSize(Index idx)
+{
+	assert(idx != NULL && idx->table != NULL);
+	return idx->table->header->nDocs;
+}
+
+// totalWords(Index)
+// - return # words in all the live documents together
+long totalWords(Index idx)
+{
+	assert(idx != NULL);
+	if (idx->owner == NULL) return idx->parts[0].header->totalWords;
+	long total = 0;
+	for (int d = 0; d < docTableSize(idx); d++) total += docLength(idx, d);
+	return total;
+}
+
+// docURL(Index,Doc)
+// - return the url of document ID Doc
+char *docURL(Index idx, int doc)
+{
+	assert(idx != NULL && doc >= 0 && doc < docTableSize(idx));
+	return idx->table->strings + idx->table->docs[doc];
+}
+
+// docLength(Index,Doc)
+// - return # words in document ID Doc, 0 if it has been deleted
+int docLength(Index idx, int doc)
+{
+	assert(idx != NULL && doc >= 0 && doc < docTableSize(idx));
+	if (idx->owner == NULL) return idx->parts[0].lengths[doc];
+	return idx->owner[doc] == DELETED ? 0 : idx->parts[idx->owner[doc]].lengths[doc];
+}
+
+// findTerm(Index,Term)
+// - binary search the dictionary for Term, returning a number for it (its place in the dictionary of a single file) or NOT_FOUND
+// - the number for a term in segments is its place in the first segment that has it, times the number of segments, plus which segment that is
+int findTerm(Index idx, char *term)
+{
+	assert(idx != NULL);
+	for (int p = 0; p < idx->nParts; p++) {
+		int place = searchPart(&idx->parts[p], term);
+		if (place != NOT_FOUND) return place*idx->nParts + p;
+	}
+	return NOT_FOUND;
+}
+
+// firstTerm(Index)
+// - return the number of the alphabetically first term in the index, or NOT_FOUND if it has none
+int firstTerm(Index idx)
+{
+	assert(idx != NULL);
+	int first = NOT_FOUND;
+	for (int p = 0; p < idx->nParts; p++) {
+		Part *part = &idx->parts[p];
+		if (part->header->nTerms == 0) continue;
+		if (first == NOT_FOUND || strcmp(part->strings + part->dictionary[0].term, termAt(idx, first)) < 0) first = p;
+	}
+	return first; // place 0 of part first
+}
+
+// nextTerm(Index,T)
+// - return the number of the term that comes alphabetically after term number T, or NOT_FOUND if T is the last
+int nextTerm(Index idx, int t)
+{
+	assert(idx != NULL);
+	char *term = termAt(idx, t);
+	int next = NOT_FOUND;
+	char *nextWord = NULL;
+	for (int p = 0; p < idx->nParts; p++) {
+		Part *part = &idx->parts[p];
+		int lo = 0, hi = part->header->nTerms; // the first term in the part after term
+		while (lo < hi) {
+			int mid = (lo + hi)/2;
+			if (strcmp(part->strings + part->dictionary[mid].term, term) > 0) hi = mid;
+			else lo = mid + 1;
+		}
+		if (lo == part->header->nTerms) continue;
+		char *word = part->strings + part->dictionary[lo].term;
+		if (nextWord == NULL || strcmp(word, nextWord) < 0) {
+			next = lo*idx->nParts + p;
+			nextWord = word;
+		}
+	}
+	return next;
+}
+
+// termAt(Index,T)
+// - return term number T
+char *termAt(Index idx, int t)
+{
+	assert(idx != NULL && t >= 0);
+	Part *part = &idx->parts[t % idx->nParts];
+	assert(t / idx->nParts < part->header->nTerms);
+	return part->strings + part->dictionary[t / idx->nParts].term;
+}
+
+// termDocs(Index,T)
+// - return # documents containing term number T, or an upper bound on it if there are segments, as some postings may be masked
+int termDocs(Index idx, int t)
+{
+	assert(idx != NULL);
+	if (idx->nParts == 1) return idx->parts[0].dictionary[t].nPostings;
+	char *term = termAt(idx, t);
+	int n = 0;
+	for (int p = t % idx->nParts; p < idx->nParts; p++) {
+		int place = searchPart(&idx->parts[p], term);
+		if (place != NOT_FOUND) n += idx->parts[p].dictionary[place].nPostings;
+	}
+	return n;
+}
+
+// getPostings(Index,T,Docs,Counts)
+// - decode the live document IDs of term number T into Docs (which has room for termDocs of them) in increasing order, returning how many
+// - the number of times the term is in each goes in Counts, unless it is NULL
+int getPostings(Index idx, int t, int *docs, int *counts)
+{
+	assert(idx != NULL && t >= 0);
+	if (idx->nParts == 1) return decodePart(idx, 0, t, docs, counts);
+	char *term = termAt(idx, t);
+	int n = 0, runs = 0;
+	for (int p = t % idx->nParts; p < idx->nParts; p++) {
+		int place = searchPart(&idx->parts[p], term);
+		if (place == NOT_FOUND) continue;
+		int found = decodePart(idx, p, place, docs + n, counts ? counts + n : NULL);
+		if (found > 0) runs++;
+		n += found;
+	}
+	if (runs > 1) { // each segment's are in order but an updated document's can come after later ones from older segments
+		int *pairs = malloc(2*n*sizeof(int));
+		assert(pairs != NULL);
+		for (int i = 0; i < n; i++) { pairs[2*i] = docs[i]; pairs[2*i+1] = counts ? counts[i] : 0; }
+		qsort(pairs, n, 2*sizeof(int), comparePostings);
+		for (int i = 0; i < n; i++) {
+			docs[i] = pairs[2*i];
+			if (counts != NULL) counts[i] = pairs[2*i+1];
+		}
+		free(pairs);
+	}
+	return n;
+}
+
+// newManifest(NDocs)
+// - create a manifest for just INDEX_FILE (generation 0), built from NDocs documents
+Manifest newManifest(int nDocs)
+{
+	Manifest new = malloc(sizeof(struct ManifestRep));
+	assert(new != NULL);
+	new->nextGen = 1;
+	new->nDocs = nDocs;
+	new->maxDocs = nDocs > 0 ? nDocs : 1;
+	new->nSegments = 1;
+	new->gens = malloc(sizeof(int));
+	new->owner = calloc(new->maxDocs, sizeof(int));
+	assert(new->gens != NULL && new->owner != NULL);
+	new->gens[0] = 0;
+	return new;
+}
+
+// readManifest(File)
+// - read the manifest in File, or return NULL if there isn't one
+// - a manifest that is cut short or garbled is reported and the program stopped, as the index it describes can't be read
+Manifest readManifest(char *fileName)
+{
+	FILE *fp = fopen(fileName, "r");
+	if (fp == NULL) return NULL;
+	int nextGen, nDocs, nSegments, defaultGen;
+	if (fscanf(fp, "manifest %d %d %d %d", &nextGen, &nDocs, &nSegments, &defaultGen) != 4 || nDocs < 0 || nSegments < 0) {
+		fprintf(stderr, "%s is cut short or garbled, run inverted to rebuild the index\n", fileName);
+		exit(1);
+	}
+	Manifest new = newManifest(nDocs);
+	new->nextGen = nextGen;
+	new->nSegments = nSegments;
+	new->gens = realloc(new->gens, (nSegments > 0 ? nSegments : 1)*sizeof(int));
+	assert(new->gens != NULL);
+	int s = 0;
+	while (s < nSegments && fscanf(fp, " segment %d", &new->gens[s]) == 1) s++;
+	for (int d = 0; d < nDocs; d++) new->owner[d] = defaultGen;
+	int doc, gen, valid = s == nSegments;
+	while (valid && fscanf(fp, " owner %d %d", &doc, &gen) == 2) {
+		valid = doc >= 0 && doc < nDocs;
+		if (valid) new->owner[doc] = gen;
+	}
+	char end[4];
+	valid = valid && fscanf(fp, " %3s", end) == 1 && strcmp(end, "end") == 0 && fscanf(fp, " %*s") == EOF; // written last, so a manifest without it was cut short
+	fclose(fp);
+	if (!valid) {
+		fprintf(stderr, "%s is cut short or garbled, run inverted to rebuild the index\n", fileName);
+		exit(1);
+	}
+	return new;
+}
+
+// writeManifest(File,Manifest)
+// - write Manifest to File, replacing it in one step so readers see either the old manifest or the new one
+void writeManifest(char *fileName, Manifest m)
+{
+	int defaultGen = m->nSegments > 0 ? m->gens[0] : DELETED, most = -1;
+	for (int s = 0; s < m->nSegments; s++) { // the segment owning the most documents, so it needs the fewest owner lines
+		int owned = 0;
+		for (int d = 0; d < m->nDocs; d++) owned += m->owner[d] == m->gens[s];
+		if (owned > most) { most = owned; defaultGen = m->gens[s]; }
+	}
+	char *tmpName = malloc(strlen(fileName) + 5);
+	assert(tmpName != NULL);
+	sprintf(tmpName, "%s.tmp", fileName);
+	FILE *fp = fopen(tmpName, "w");
+	assert(fp != NULL);
+	fprintf(fp, "manifest %d %d %d %d\n", m->nextGen, m->nDocs, m->nSegments, defaultGen);
+	for (int s = 0; s < m->nSegments; s++) fprintf(fp, "segment %d\n", m->gens[s]);
+	for (int d = 0; d < m->nDocs; d++) if (m->owner[d] != defaultGen) fprintf(fp, "owner %d %d\n", d, m->owner[d]);
+	fprintf(fp, "end\n");
+	if (ferror(fp) | fclose(fp) || rename(tmpName, fileName) != 0) {
+		perror(fileName);
+		unlink(tmpName);
+		exit(1);
+	}
+	free(tmpName);
+}
+
+// freeManifest(Manifest)
+// - clean up memory associated with Manifest
+void freeManifest(Manifest m)
+{
+	if (m == NULL) return;
+	free(m->gens); free(m->owner);
+	free(m);
+}
+
+// segmentFile(Gen,Name)
+// - put the file name of the segment with generation Gen in Name; generation 0 is the full build in INDEX_FILE
+void segmentFile(int gen, char *name)
+{
+	if (gen == 0) strcpy(name, INDEX_FILE);
+	else sprintf(name, "invertedIndex.%d.bin", gen);
+}
+
+// Helper functions
+
+// copies s onto the end of the strings, returning where it starts
+static int addString(IndexWriter w, char *s)
+{
+	int len = strlen(s) + 1;
+	while (w->nStrings + len > w->maxStrings) {
+		w->maxStrings *= 2;
+		w->strings = realloc(w->strings, w->maxStrings);
+		assert(w->strings != NULL);
+	}
+	memcpy(w->strings + w->nStrings, s, len);
+	w->nStrings += len;
+	return w->nStrings - len;
+}
+
+// maps the index in File into part, returning 0 if there isn't a valid one
+static int mapPart(char *fileName, Part *part)
+{
+	int fd = open(fileName, O_RDONLY);
+	if (fd == -1) return 0;
+	struct stat st;
+	char *base = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(IndexHeader)) base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) return 0;
+	IndexHeader *header = (IndexHeader *)base;
+	if (header->magic != INDEX_MAGIC || header->size != st.st_size) {
+		munmap(base, st.st_size);
+		return 0;
+	}
+	part->base = base;
+	part->size = st.st_size;
+	part->header = header;
+	part->strings = base + header->strings;
+	part->docs = (int *)(base + header->docs);
+	part->lengths = (int *)(base + header->lengths);
+	part->dictionary = (Entry *)(base + header->dictionary);
+	return 1;
+}
+
+// binary searches part's dictionary for term, returning its place or NOT_FOUND
+static int searchPart(Part *part, char *term)
+{
+	int lo = 0, hi = part->header->nTerms;
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+		int cmp = strcmp(term, part->strings + part->dictionary[mid].term);
+		if (cmp == 0) return mid;
+		if (cmp > 0) lo = mid + 1;
+		else hi = mid;
+	}
+	return NOT_FOUND;
+}
+
+// decodes the postings at place in part p's dictionary, leaving out documents that part doesn't own, and returns how many were kept
+static int decodePart(Index idx, int p, int place, int *docs, int *counts)
+{
+	Entry *e = &idx->parts[p].dictionary[place];
+	unsigned char *bytes = (unsigned char *)idx->parts[p].base + e->postings;
+	int n = 0;
+	for (int i = 0, doc = 0; i < e->nPostings; i++) {
+		unsigned value[2] = { 0, 0 }; // the gap then the count
+		for (int v = 0; v < 2; v++) {
+			for (int shift = 0; ; shift += 7) {
+				value[v] |= (unsigned)(*bytes & 0x7f) << shift;
+				if (!(*bytes++ & 0x80)) break;
+			}
+		}
+		doc += value[0];
+		if (idx->owner != NULL && idx->owner[doc] != p) continue;
+		docs[n] = doc;
+		if (counts != NULL) counts[n] = value[1];
+		n++;
+	}
+	return n;
+}
+
+// orders (document ID, count) pairs by document ID
+static int comparePostings(const void *a, const void *b)
+{
+	return *(int *)a - *(int *)b;
+}
+
+// writes n as a varint, returning how many bytes it took
+static int putVarint(unsigned char *bytes, unsigned n)
+{
+	int nBytes = 0;
+	while (n >= 0x80) {
+		bytes[nBytes++] = (n & 0x7f) | 0x80;
+		n >>= 7;
+	}
+	bytes[nBytes++] = n;
+	return nBytes;
+}
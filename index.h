@@ -0,0 +1,55 @@
+// index.h ... interface to binary inverted index
+// A sorted term dictionary plus delta and varint encoded postings of document IDs and term counts, read through mmap
+// An index updated in place is several segment files, listed with which segment holds each document in a manifest
+
+#ifndef INDEX_H
+#define INDEX_H
+
+#include "URL.h"
+
+#define INDEX_FILE "invertedIndex.bin"
+#define INDEX_MANIFEST "invertedIndex.manifest" // the segments, once inverted -u has updated the index since the last full build
+#define DELETED -1
+
+typedef struct IndexRep *Index;
+typedef struct IndexWriterRep *IndexWriter;
+
+typedef struct ManifestRep {
+	int   nextGen;     // generation number for the next segment written
+	int   nDocs;       // document IDs given out so far
+	int   maxDocs;     // capacity of owner[]
+	int   nSegments;
+	int   *gens;       // each segment's generation, oldest first
+	int   *owner;      // owner[doc] is the generation of the segment with doc's live postings, or DELETED
+} *Manifest;
+
+// Function signatures
+
+IndexWriter newIndexWriter(char *,URLQueue);
+void  setDocLength(IndexWriter,int,int);
+void  addTerm(IndexWriter,char *,int,int *,int *);
+void  closeIndexWriter(IndexWriter);
+
+Index openIndex(char *);
+Index openCurrentIndex();
+Index openSegments(Manifest,int *,int);
+void  closeIndex(Index);
+int   nDocs(Index);
+int   docTableSize(Index);
+long  totalWords(Index);
+char *docURL(Index,int);
+int   docLength(Index,int);
+int   findTerm(Index,char *);
+int   firstTerm(Index);
+int   nextTerm(Index,int);
+char *termAt(Index,int);
+int   termDocs(Index,int);
+int   getPostings(Index,int,int *,int *);
+
+Manifest newManifest(int);
+Manifest readManifest(char *);
+void  writeManifest(char *,Manifest);
+void  freeManifest(Manifest);
+void  segmentFile(int,char *);
+
+#endif
@@ -3,180 +3,512 @@
 #include <stdio.h>
 #include <ctype.h>
 #include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
 #include "URL.h"
 #include "utility.h"
+#include "index.h"
+#include "inverted.h"
 
 //Creates an inverted index file of all words in the URL files named in collection.txt
 //By George Fidler
 //9/10/17
 
-typedef struct _wordnode *WordNode;
+#define MIN_TERMS 1024
+#define MIN_POSTINGS 4
+#define RANGES_PER_THREAD 4 //documents are split into this many ranges per thread, so a thread that gets quick ranges can take more
+#define TERM_OVERHEAD 72     //rough bytes a word costs the dictionary beyond its letters and postings: hash slots, key pointer, malloc headers
+#define MIN_IO_BUFFER 65536  //segments are read and written through buffers of 64KB to 4MB, depending on the budget
+#define MAX_IO_BUFFER 4194304
 
-struct _wordnode {
-    char *word;
-    URLQueue URLs;
-    WordNode next;
-    WordNode prev;
+typedef struct _ingest {     //documents being read by a pool of threads, each range of them into its own dictionary
+    char **docURLs;
+    int *docLengths;
+    int nRanges;
+    int *rangeStart;         //range r is documents rangeStart[r] .. rangeStart[r+1]-1
+    Dictionary *partial;     //partial[r] holds just range r's documents
+    pthread_mutex_t lock;
+    int nextRange;           //the next range for a thread to take
+} Ingest;
 
-} wordnode;
+typedef struct _output {     //invertedIndex.txt and the binary index, written a term at a time in alphabetical order
+    FILE *text;
+    IndexWriter binary;
+    char **docURLs;          //docURLs[document ID]
+} Output;
 
-typedef struct _wordlist *WordList;
+typedef struct _segment {    //a sorted run of the dictionary written out to a temporary file by -m
+    FILE *fp;
+    char *buffer;
+    char word[MAX_LINE];     //the word the file is up to; a word comes from one line so fits
+    int n;                   //and how many postings it has, which are next in the file
+} Segment;
 
-struct _wordlist {
-    WordNode head;
-    WordNode tail;
-} wordlist;
+Dictionary readDocuments(URLQueue,int*,int);
+void *ingestThread(void*);
+void appendPostings(Dictionary,Dictionary);
+void writeIndexes(Dictionary,URLQueue,int*);
+Output openOutput(URLQueue,int*);
+void writeTerm(Output*,char*,int,int*,int*);
+void closeOutput(Output*);
+void buildInBudget(URLQueue,int*,long);
+int ioBuffer(long);
+int writeSegment(Dictionary,int);
+FILE *newSegmentFile(char*,int);
+void writeRecord(FILE*,char*,int,int*,int*);
+int finishSegment(FILE*);
+int readSegmentTerm(Segment*);
+void segmentFailed(FILE*,char*);
+void mergeSegments(int*,int,URLQueue,int*,long);
+int mergeRun(int*,int,long,Output*);
 
-WordList newWordList();
-WordNode newWordNode(char*,char*,WordList,URLQueue);
-void addURL(char*,WordNode,URLQueue);
-void insertNode(WordNode,WordNode,WordList);
-void addWord(char*,char*,WordList,URLQueue);
-void freeWordList(WordList);
+int main(int argc, char *argv[]) {
+    if (argc > 2 && strEQ(argv[1], "-u")) { //-u <url> ... re-reads just those URLs into a new segment, or deletes them if they have left collection.txt
+        updateIndex(argc-2, argv+2);
+        return 0;
+    }
+    if (argc == 2 && strEQ(argv[1], "-M")) { //-M merges the updated segments now rather than leaving it to the background
+        mergeTiers(1);
+        return 0;
+    }
+    int nThreads = 1, budget = 0;
+    int badOption = 0;
+    for (int i = 1; i < argc && !badOption; i++) {
+        if (strEQ(argv[i], "-t") && i+1 < argc) nThreads = atoi(argv[++i]); //-t <threads> reads the URL files with a pool of threads
+        else if (strEQ(argv[i], "-m") && i+1 < argc) { //-m <megabytes> builds the indexes within a memory budget, spilling to temporary files
+            budget = atoi(argv[++i]);
+            if (budget < 1) badOption = 1;
+        }
+        else badOption = 1;
+    }
+    if (nThreads < 1) badOption = 1;
+    if (budget > 0 && nThreads > 1) badOption = 1; //the budget is for one dictionary at a time
+    if (badOption) {
+        fprintf(stderr, "Usage: [-t <threads>] [-m <megabytes>] | -u <url> <url> ... | -M\n");
+        return 1;
+    }
+    removeSegments(); //a full build replaces any updates
+    URLQueue urls = getURLS();          //creates linked list of all URLs in collection.txt
+    int *docLengths = calloc(urls->len > 0 ? urls->len : 1, sizeof(int)); //number of words in section 2 of each URL, for tf
+    assert(docLengths);
+    if (budget > 0) buildInBudget(urls, docLengths, (long)budget*1024*1024);
+    else {
+        Dictionary dict = readDocuments(urls, docLengths, nThreads);  //all words in URL files
+        writeIndexes(dict, urls, docLengths);
+        freeDictionary(dict);
+    }
+    free(docLengths);
+    freeURLQueue(urls);
+    return 0;
+}
 
-int main(void) {
-    URLQueue urls = getURLS();     //creates linked list of all URLs in collection.txt
-    WordList list = newWordList(); //list of all words in URL files
+//Reads section 2 of a URL file, adding each word to the dictionary as being in document ID doc and counting the words
+void readDocument(Dictionary dict, char *url, int doc, int *docLengths) {
     char buffer[MAX_LINE] = {0};
     int startRead = 0;
-
-    URLNode mover = urls->head;
-    while (mover) {
-        char *urlFileName = concat(mover->URL, ".txt"); //adds .txt to actually open the file related to each URL.
-        FILE *fp = fopen(urlFileName, "r"); assert(fp);
-        free(urlFileName);
-        while (fgets(buffer, MAX_LINE, fp)) {  //only start reading words from that file once in section-2
-            if (startRead != 1) {
-                if (strEQ(buffer, "#start Section-2\n")) startRead = 1;
-                continue;
-            }
-            if (buffer[0] == '#' && buffer[1] == 'e') break;  //finish at the end of section 2
-
-            char *token = strtok(buffer, " \n");   //reads each word out of section 2 individually
-            while (token) {
-                normaliseWord(token);     //normalises them
-                addWord(mover->URL, token, list, urls); //and adds them to the word list (with the current URL inside the wordnode)
-                token = strtok(NULL, " \n");
-            }
+    char *urlFileName = concat(url, ".txt"); //adds .txt to actually open the file related to each URL.
+    FILE *fp = fopen(urlFileName, "r"); assert(fp);
+    free(urlFileName);
+    while (fgets(buffer, MAX_LINE, fp)) {  //only start reading words from that file once in section-2
+        if (startRead != 1) {
+            if (strEQ(buffer, "#start Section-2\n")) startRead = 1;
+            continue;
         }
+        if (buffer[0] == '#' && buffer[1] == 'e') break;  //finish at the end of section 2
 
-        mover = mover->next;
-        fclose(fp);
-        startRead = 0;
+        char *rest;
+        char *token = strtok_r(buffer, " \n", &rest);   //reads each word out of section 2 individually (strtok_r as other threads are tokenising too)
+        while (token) {
+            normaliseWord(token);     //normalises them
+            addOccurrence(dict, token, doc); //and adds them to the dictionary
+            docLengths[doc]++;
+            token = strtok_r(NULL, " \n", &rest);
+        }
     }
+    fclose(fp);
+}
+
+/*
+Splits the documents into consecutive ranges and has nThreads threads (the calling thread included) take ranges until there are none left,
+reading each range into its own dictionary. The ranges' dictionaries are then merged in range order, so every term's postings
+come out in document ID order just as if the documents were read one after another.
+*/
+Dictionary readDocuments(URLQueue urls, int *docLengths, int nThreads) {
+    Ingest ingest = { .docLengths = docLengths, .nextRange = 0 };
+    ingest.nRanges = nThreads == 1 ? 1 : nThreads*RANGES_PER_THREAD;
+    if (ingest.nRanges > urls->len) ingest.nRanges = urls->len > 0 ? urls->len : 1;
+    ingest.docURLs = malloc((urls->len > 0 ? urls->len : 1)*sizeof(char*));
+    ingest.rangeStart = malloc((ingest.nRanges+1)*sizeof(int));
+    ingest.partial = malloc(ingest.nRanges*sizeof(Dictionary));
+    pthread_t *threads = malloc(nThreads*sizeof(pthread_t));
+    assert(ingest.docURLs && ingest.rangeStart && ingest.partial && threads);
+    int doc = 0;
+    for (URLNode mover = urls->head; mover; mover = mover->next) ingest.docURLs[doc++] = mover->URL;
+    for (int r = 0; r <= ingest.nRanges; r++) ingest.rangeStart[r] = (long)urls->len*r/ingest.nRanges;
+
+    pthread_mutex_init(&ingest.lock, NULL);
+    for (int t = 1; t < nThreads; t++) pthread_create(&threads[t], NULL, ingestThread, &ingest);
+    ingestThread(&ingest);
+    for (int t = 1; t < nThreads; t++) pthread_join(threads[t], NULL);
+    pthread_mutex_destroy(&ingest.lock);
 
-    FILE *fp = fopen("invertedIndex.txt" , "w+");
-    WordNode curr = list->head;
-    while (curr) {   //prints words and all URLs they're present in in alphabetical order
-        fprintf(fp, "%s  ", curr->word);
-        for (URLNode mover = curr->URLs->head; mover; mover = mover->next) fprintf(fp, "%s ", mover->URL);
-        fprintf(fp, "\n");
-        curr = curr->next;
+    Dictionary dict = ingest.partial[0];
+    for (int r = 1; r < ingest.nRanges; r++) {
+        appendPostings(dict, ingest.partial[r]);
+        freeDictionary(ingest.partial[r]);
     }
+    free(ingest.docURLs); free(ingest.rangeStart); free(ingest.partial); free(threads);
+    return dict;
+}
 
-    fclose(fp);
-    freeWordList(list);
-    freeURLQueue(urls);
-    return 0;
+//Keeps taking the next range of documents and reading it into a new dictionary until there are none left
+void *ingestThread(void *arg) {
+    Ingest *ingest = arg;
+    while (1) {
+        pthread_mutex_lock(&ingest->lock);
+        int r = ingest->nextRange++;
+        pthread_mutex_unlock(&ingest->lock);
+        if (r >= ingest->nRanges) break;
+        ingest->partial[r] = newDictionary();
+        for (int doc = ingest->rangeStart[r]; doc < ingest->rangeStart[r+1]; doc++) readDocument(ingest->partial[r], ingest->docURLs[doc], doc, ingest->docLengths);
+    }
+    return NULL;
 }
 
+//Adds every term's postings in from to the end of that term's postings in dict. from's documents must all come after dict's
+void appendPostings(Dictionary dict, Dictionary from) {
+    for (int t = 0; t < from->nTerms; t++) {
+        Postings *src = &from->postings[t];
+        char *word = keyOf(from->terms, t);
+        int id = findID(dict->terms, word);
+        if (id == NOT_FOUND) {   //a word dict hasn't seen: make it a first posting then copy the rest below
+            addOccurrence(dict, word, src->docs[0]);
+            id = dict->nTerms-1;
+            dict->postings[id].n = 0;
+        }
+        Postings *dest = &dict->postings[id];
+        if (dest->n + src->n > dest->max) {
+            while (dest->n + src->n > dest->max) dest->max *= 2;
+            dest->docs = realloc(dest->docs, dest->max*sizeof(int));
+            dest->counts = realloc(dest->counts, dest->max*sizeof(int));
+            assert(dest->docs && dest->counts);
+        }
+        memcpy(dest->docs + dest->n, src->docs, src->n*sizeof(int));
+        memcpy(dest->counts + dest->n, src->counts, src->n*sizeof(int));
+        dest->n += src->n;
+    }
+}
 
-//List of all words in the URL files, stored alphabetically.
-WordList newWordList() { 
-    WordList new = malloc(sizeof(wordlist));
+Dictionary newDictionary() {
+    Dictionary new = malloc(sizeof(struct _dictionary));
     assert(new);
-    new->head = NULL;
-    new->tail = NULL;
+    new->terms = newHashTable(MIN_TERMS);
+    new->nTerms = 0;
+    new->maxTerms = MIN_TERMS;
+    new->postings = malloc(new->maxTerms*sizeof(Postings));
+    assert(new->postings);
+    new->bytes = new->maxTerms*(sizeof(Postings) + TERM_OVERHEAD);
     return new;
 }
 
-//Individual word stored here with a an array of URLs it appears in. 
-WordNode newWordNode(char *currURL, char *word, WordList list, URLQueue urls) {    
-    WordNode new =  malloc(sizeof(wordnode));
-    assert(new);
+/*
+Adds one occurrence of a word in document ID doc: a hash lookup for the word's postings, then either a new posting on the end
+or one more for the last posting. Documents are read in order, so the word can only already be in doc if doc is its last posting.
+*/
+void addOccurrence(Dictionary dict, char *word, int doc) {
+    int id = getID(dict->terms, word);
+    if (id == dict->nTerms) {   //a word we haven't seen before
+        if (dict->nTerms == dict->maxTerms) {
+            dict->bytes += dict->maxTerms*(sizeof(Postings) + TERM_OVERHEAD);
+            dict->maxTerms *= 2;
+            dict->postings = realloc(dict->postings, dict->maxTerms*sizeof(Postings));
+            assert(dict->postings);
+        }
+        dict->bytes += strlen(word) + 1 + 2*MIN_POSTINGS*sizeof(int);
+        Postings *p = &dict->postings[dict->nTerms++];
+        p->n = 0;
+        p->max = MIN_POSTINGS;
+        p->docs = malloc(p->max*sizeof(int));
+        p->counts = malloc(p->max*sizeof(int));
+        assert(p->docs && p->counts);
+    }
+    Postings *p = &dict->postings[id];
+    if (p->n > 0 && p->docs[p->n-1] == doc) {
+        p->counts[p->n-1]++;
+        return;
+    }
+    if (p->n == p->max) {
+        dict->bytes += 2*p->max*sizeof(int);
+        p->max *= 2;
+        p->docs = realloc(p->docs, p->max*sizeof(int));
+        p->counts = realloc(p->counts, p->max*sizeof(int));
+        assert(p->docs && p->counts);
+    }
+    p->docs[p->n] = doc;
+    p->counts[p->n++] = 1;
+}
 
-    new->word = calloc(strlen(word)+1, sizeof(char)); //+1 for null terminator
-    assert(new->word);
-     
-    strcpy(new->word, word);
+static HashTable sortingTerms; //qsort's compare function only gets the two elements, so it finds the words here
 
-    new->URLs = newURLQueue();
-    addURL(currURL, new, urls);    //adds URL in which the word was first sighted
+static int compareTerms(const void *a, const void *b) {
+    return strcmp(keyOf(sortingTerms, *(int *)a), keyOf(sortingTerms, *(int *)b));
+}
 
-    new->next = NULL;
-    new->prev = NULL;
+//Returns the term IDs in alphabetical order of their words, sorted once now that every word has been seen
+int *sortTerms(Dictionary dict) {
+    int *order = malloc((dict->nTerms > 0 ? dict->nTerms : 1)*sizeof(int));
+    assert(order);
+    for (int t = 0; t < dict->nTerms; t++) order[t] = t;
+    sortingTerms = dict->terms;
+    qsort(order, dict->nTerms, sizeof(int), compareTerms);
+    return order;
+}
 
-    if(list->head == NULL) {
-        list->head = new;
-        list->tail = new;
-    } 
+//Prints words and all URLs they're present in, in alphabetical order, to invertedIndex.txt and the binary index
+void writeIndexes(Dictionary dict, URLQueue urls, int *docLengths) {
+    int *order = sortTerms(dict);
+    Output out = openOutput(urls, docLengths);
+    for (int t = 0; t < dict->nTerms; t++) {
+        Postings *p = &dict->postings[order[t]];
+        writeTerm(&out, keyOf(dict->terms, order[t]), p->n, p->docs, p->counts);
+    }
+    closeOutput(&out);
+    free(order);
+}
 
-    return new;
+Output openOutput(URLQueue urls, int *docLengths) {
+    Output out;
+    out.docURLs = malloc((urls->len > 0 ? urls->len : 1)*sizeof(char*));
+    assert(out.docURLs);
+    int doc = 0;
+    for (URLNode mover = urls->head; mover; mover = mover->next) out.docURLs[doc++] = mover->URL;
+    out.text = fopen("invertedIndex.txt.tmp" , "w+"); //renamed into place when done, like the binary index, so searches never read half of it
+    assert(out.text);
+    out.binary = newIndexWriter(INDEX_FILE, urls);
+    for (int d = 0; d < urls->len; d++) setDocLength(out.binary, d, docLengths[d]);
+    return out;
 }
 
-void addWord(char *currURL, char *word, WordList list, URLQueue urls) {
-    if (!list->head) {        //if this is the first wordNode, no need to sort.
-        newWordNode(currURL, word, list, urls);
-        return;
-    }
+//Prints a word and the URLs of its n postings. Words must come in alphabetical order
+void writeTerm(Output *out, char *word, int n, int *docs, int *counts) {
+    fprintf(out->text, "%s  ", word);
+    for (int i = 0; i < n; i++) fprintf(out->text, "%s ", out->docURLs[docs[i]]);
+    fprintf(out->text, "\n");
+    addTerm(out->binary, word, n, docs, counts);
+}
 
-    WordNode mover = list->head;
-    WordNode newNode = NULL;
+void closeOutput(Output *out) {
+    closeIndexWriter(out->binary);
+    if (ferror(out->text) | fclose(out->text) || rename("invertedIndex.txt.tmp", "invertedIndex.txt") != 0) {
+        perror("invertedIndex.txt");
+        exit(1);
+    }
+    free(out->docURLs);
+}
 
-    while (mover) {       //finds the appropriate alphabetical spot for the word.
-        int cmp = strcmp(word, mover->word);
-        if (cmp == 0) {
-            addURL(currURL, mover, urls);
-            return;
-        } 
-        else if (cmp < 0) {
-            newNode = newWordNode(currURL, word, list, urls);
-            insertNode(newNode, mover, list);     //inserts wordNode into spot in the list
-            return;
+/*
+Builds the indexes in about budget bytes of memory, for collections whose postings don't fit in memory.
+Documents are read in order as usual, but whenever the dictionary reaches half the budget it is sorted and written out to a
+temporary segment file and a new one started. Segments are only cut between documents, so every segment's documents come
+after the last one's. If it never fills up the indexes are written straight from the dictionary, otherwise the segments are merged.
+The other half is for the I/O buffers (a quarter of the budget at most) and for memory the allocator holds on to after a
+dictionary is freed. The URL list, document lengths and the binary index's term table still grow with the collection,
+but at a few dozen bytes per document and word rather than per posting.
+*/
+void buildInBudget(URLQueue urls, int *docLengths, long budget) {
+    int nSegments = 0, maxSegments = 16;
+    int *segments = malloc(maxSegments*sizeof(int));
+    assert(segments);
+    int bufferSize = ioBuffer(budget/16);
+    Dictionary dict = newDictionary();
+    int doc = 0;
+    for (URLNode mover = urls->head; mover; mover = mover->next) {
+        readDocument(dict, mover->URL, doc++, docLengths);
+        if (dict->bytes < budget/2 && (mover->next || nSegments == 0)) continue;  //the last documents go in a segment too if there are others
+        if (nSegments == maxSegments) {
+            maxSegments *= 2;
+            segments = realloc(segments, maxSegments*sizeof(int));
+            assert(segments);
         }
+        segments[nSegments++] = writeSegment(dict, bufferSize);
+        freeDictionary(dict);
+        dict = newDictionary();
+    }
+    if (nSegments == 0) writeIndexes(dict, urls, docLengths);
+    freeDictionary(dict);
+    if (nSegments > 0) mergeSegments(segments, nSegments, urls, docLengths, budget);
+    free(segments);
+}
 
-        mover = mover->next;
+//A buffer size for segment I/O of about size bytes
+int ioBuffer(long size) {
+    return size < MIN_IO_BUFFER ? MIN_IO_BUFFER : size > MAX_IO_BUFFER ? MAX_IO_BUFFER : size;
+}
+
+//Writes the dictionary's words to a new segment in alphabetical order, returning a descriptor for it
+int writeSegment(Dictionary dict, int bufferSize) {
+    char *buffer = malloc(bufferSize);
+    assert(buffer);
+    FILE *fp = newSegmentFile(buffer, bufferSize);
+    int *order = sortTerms(dict);
+    for (int t = 0; t < dict->nTerms; t++) {
+        Postings *p = &dict->postings[order[t]];
+        writeRecord(fp, keyOf(dict->terms, order[t]), p->n, p->docs, p->counts);
     }
-    newNode = newWordNode(currURL, word, list, urls);
-    insertNode(newNode, NULL, list);
+    int fd = finishSegment(fp);
+    free(buffer); free(order);
+    return fd;
 }
 
-//Inserts wordNode into the list in spot determined in addWord
-void insertNode(WordNode newNode, WordNode afterNode, WordList list) {
-    if (!afterNode) {
-        list->tail->next = newNode;
-        newNode->prev = list->tail;
-        list->tail = newNode;
-    } 
-    else if (afterNode == list->head) {
-        list->head->prev = newNode;
-        newNode->next = list->head;
-        list->head = newNode;
-    } 
-    else {
-        afterNode->prev->next = newNode;
-        newNode->prev = afterNode->prev;
-        afterNode->prev = newNode;
-        newNode->next = afterNode;
+FILE *newSegmentFile(char *buffer, int bufferSize) {
+    FILE *fp = tmpfile();  //deleted once the last descriptor for it is closed
+    if (!fp) segmentFailed(NULL, "created");
+    setvbuf(fp, buffer, _IOFBF, bufferSize);
+    return fp;
+}
+
+//A segment is its words in alphabetical order, each as its length, letters, number of postings, documents then counts
+void writeRecord(FILE *fp, char *word, int n, int *docs, int *counts) {
+    int length = strlen(word) + 1;
+    fwrite(&length, sizeof(int), 1, fp);
+    fwrite(word, 1, length, fp);
+    fwrite(&n, sizeof(int), 1, fp);
+    fwrite(docs, sizeof(int), n, fp);
+    fwrite(counts, sizeof(int), n, fp);
+}
+
+//Closes a written segment, returning a descriptor for it rewound to the start so it can be opened again with a new buffer
+int finishSegment(FILE *fp) {
+    int fd = fflush(fp) == 0 && !ferror(fp) ? dup(fileno(fp)) : -1;
+    if (fd == -1 || lseek(fd, 0, SEEK_SET) != 0) segmentFailed(NULL, "written");
+    fclose(fp);
+    return fd;
+}
+
+//Reads the next word and its number of postings from a segment, returning 0 once there are none left
+int readSegmentTerm(Segment *seg) {
+    int length;
+    if (fread(&length, sizeof(int), 1, seg->fp) != 1) {
+        if (ferror(seg->fp)) segmentFailed(seg->fp, "read back");
+        return 0;
     }
+    int whole = length > 0 && length <= MAX_LINE && fread(seg->word, 1, length, seg->fp) == (size_t)length;
+    if (!whole || fread(&seg->n, sizeof(int), 1, seg->fp) != 1 || seg->n < 0) segmentFailed(seg->fp, "read back");
+    return 1;
 }
 
-//Adds URL to wordNode
-void addURL(char *URL, WordNode presentWord, URLQueue urls) {
-    for (URLNode mover = presentWord->URLs->head; mover; mover = mover->next) {                            
-        if (strEQ(URL, mover->URL)) return;   //if URL is already present in wordNode, no need to add it.
+//Stops the build when a temporary segment can't be made, written or read back in full, e.g. when the disk is full.
+//fp is the segment being read, to tell a read error from one cut short, or NULL when errno says what went wrong
+void segmentFailed(FILE *fp, char *what) {
+    fprintf(stderr, "A temporary segment file could not be %s: %s\n", what, !fp || ferror(fp) ? strerror(errno) : "it is cut short");
+    exit(1);
+}
+
+/*
+Merges the segments into the indexes. Each segment being merged is read sequentially through its own buffer of at least
+MIN_IO_BUFFER, out of a quarter of the budget, so if there are more segments than that allows, runs of consecutive
+segments are first merged into bigger ones until there are few enough.
+*/
+void mergeSegments(int *segments, int nSegments, URLQueue urls, int *docLengths, long budget) {
+    int fanIn = budget/4/MIN_IO_BUFFER;
+    if (fanIn < 2) fanIn = 2;
+    while (nSegments > fanIn) {
+        int merged = 0;
+        for (int s = 0; s < nSegments; s += fanIn) {
+            int k = nSegments - s < fanIn ? nSegments - s : fanIn;
+            segments[merged++] = k == 1 ? segments[s] : mergeRun(segments + s, k, budget, NULL);
+        }
+        nSegments = merged;
+    }
+    Output out = openOutput(urls, docLengths);
+    mergeRun(segments, nSegments, budget, &out);
+    closeOutput(&out);
+}
+
+static Segment *mergingSegments; //the heap compares the words the segments are up to
+
+//Segment a comes before b if it is up to an earlier word, or the same word but holds earlier documents
+static int segmentBefore(int a, int b) {
+    int cmp = strcmp(mergingSegments[a].word, mergingSegments[b].word);
+    return cmp < 0 || (cmp == 0 && a < b);
+}
+
+static void siftDown(int *heap, int size, int i) {
+    while (2*i+1 < size) {
+        int child = 2*i+1;
+        if (child+1 < size && segmentBefore(heap[child+1], heap[child])) child++;
+        if (!segmentBefore(heap[child], heap[i])) break;
+        int swap = heap[i]; heap[i] = heap[child]; heap[child] = swap;
+        i = child;
+    }
+}
+
+/*
+Merges k consecutive segments with a heap of them ordered by the word each is up to, closing them as it goes.
+A word's postings are gathered from every segment that has it, earliest segment first, which keeps them in document order,
+then written to out, or to a new segment whose descriptor is returned if out is NULL.
+*/
+int mergeRun(int *fds, int k, long budget, Output *out) {
+    Segment *segs = malloc(k*sizeof(Segment));
+    int *heap = malloc(k*sizeof(int));
+    assert(segs && heap);
+    int bufferSize = ioBuffer(budget/4/k), size = 0;
+    mergingSegments = segs;
+    for (int s = 0; s < k; s++) {
+        segs[s].fp = fdopen(fds[s], "rb");
+        segs[s].buffer = malloc(bufferSize);
+        assert(segs[s].fp && segs[s].buffer);
+        setvbuf(segs[s].fp, segs[s].buffer, _IOFBF, bufferSize);
+        if (readSegmentTerm(&segs[s])) heap[size++] = s;
+    }
+    for (int i = size/2 - 1; i >= 0; i--) siftDown(heap, size, i);
+
+    char *outBuffer = NULL;
+    FILE *merged = NULL;
+    if (!out) {
+        outBuffer = malloc(ioBuffer(budget/16));
+        assert(outBuffer);
+        merged = newSegmentFile(outBuffer, ioBuffer(budget/16));
+    }
+    int n, max = MIN_POSTINGS;
+    int *docs = malloc(max*sizeof(int)), *counts = malloc(max*sizeof(int));
+    char word[MAX_LINE];
+    assert(docs && counts);
+    while (size > 0) {
+        strcpy(word, segs[heap[0]].word);
+        for (n = 0; size > 0 && strEQ(segs[heap[0]].word, word); ) {
+            Segment *seg = &segs[heap[0]];
+            if (n + seg->n > max) {
+                while (n + seg->n > max) max *= 2;
+                docs = realloc(docs, max*sizeof(int));
+                counts = realloc(counts, max*sizeof(int));
+                assert(docs && counts);
+            }
+            size_t nDocs = fread(docs + n, sizeof(int), seg->n, seg->fp), nCounts = fread(counts + n, sizeof(int), seg->n, seg->fp);
+            if (nDocs != (size_t)seg->n || nCounts != (size_t)seg->n) segmentFailed(seg->fp, "read back");
+            n += seg->n;
+            if (!readSegmentTerm(seg)) heap[0] = heap[--size];
+            siftDown(heap, size, 0);
+        }
+        if (out) writeTerm(out, word, n, docs, counts);
+        else writeRecord(merged, word, n, docs, counts);
+    }
+    for (int s = 0; s < k; s++) {
+        fclose(segs[s].fp);
+        free(segs[s].buffer);
     }
-    newURLNode(URL, presentWord->URLs);
+    int fd = merged ? finishSegment(merged) : -1;
+    free(outBuffer); free(docs); free(counts); free(segs); free(heap);
+    return fd;
 }
 
-void freeWordList(WordList l) {
-    WordNode wNode = l->head;
-    while (wNode) {
-        WordNode wPrev = wNode;
-        wNode = wNode->next;
-        free(wPrev->word);
-        freeURLQueue(wPrev->URLs);
-        free(wPrev);
+void freeDictionary(Dictionary dict) {
+    for (int t = 0; t < dict->nTerms; t++) {
+        free(dict->postings[t].docs);
+        free(dict->postings[t].counts);
     }
-    free(l);
+    free(dict->postings);
+    disposeHashTable(dict->terms);
+    free(dict);
 }
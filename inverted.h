@@ -0,0 +1,35 @@
+#ifndef INVERTED_H
+#define INVERTED_H
+
+#include "URL.h"
+#include "index.h"
+
+typedef struct _postings {   //the URLs a word is in, as document IDs (places in collection.txt), and how many times it is in each
+    int n;
+    int max;
+    int *docs;
+    int *counts;
+} Postings;
+
+typedef struct _dictionary *Dictionary;
+
+struct _dictionary {
+    HashTable terms;     //word -> term ID, in the order words were first seen
+    int nTerms;
+    int maxTerms;
+    Postings *postings;  //postings[term ID]
+    long bytes;          //an estimate of the memory all this takes, so -m knows when to write it out
+};
+
+Dictionary newDictionary();
+void addOccurrence(Dictionary,char*,int);
+void readDocument(Dictionary,char*,int,int*);
+int *sortTerms(Dictionary);
+void freeDictionary(Dictionary);
+
+//inverted -u: updating the index in place with new segments, see invertedUpdate.c
+void updateIndex(int,char*[]);
+void mergeTiers(int);
+void removeSegments();
+
+#endif
@@ -0,0 +1,286 @@
+//Updating the inverted index in place: inverted -u reads just the URLs it is given into a new segment and masks their
+//postings in the older segments, without touching the rest of the index. Small segments are merged in the background
+//so queries don't have to look through more and more of them
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include "URL.h"
+#include "index.h"
+#include "inverted.h"
+
+#define INDEX_LOCK "invertedIndex.lock"     //held while the manifest is being changed
+#define MERGE_LOCK "invertedIndex.merging"  //held by the merge, so only one runs at a time
+#define MERGE_FACTOR 4   //a tier's segments are merged once it has this many
+#define TIER_DOCS 256    //segments holding under this many live documents are tier 0, each tier after holds up to MERGE_FACTOR times more
+#define MIN_POSTINGS 4
+
+static int lockFile(char*,int);
+static void unlockFile(int);
+static URLQueue docTable(Index);
+static void mergeInBackground();
+static int pickMerge(Manifest,int*);
+static void compactSegments(Manifest,int*,int,int);
+static int compareIDs(const void*,const void*);
+
+/*
+Re-reads each of the urls into a new segment, giving urls that are new to the index the next document IDs, and makes the new
+segment the owner of their documents so the postings in older segments are masked. Urls that are no longer in collection.txt
+are deleted instead. The first update after a full build turns INDEX_FILE into segment 0 of a new manifest.
+Documents keep their IDs, so a url added to the end of collection.txt gets the same ID a full build would give it.
+invertedIndex.txt is left as the last full build wrote it.
+*/
+void updateIndex(int nURLs, char *urls[]) {
+    int lock = lockFile(INDEX_LOCK, LOCK_EX);
+    Manifest m = readManifest(INDEX_MANIFEST);
+    if (!m) {
+        Index base = openIndex(INDEX_FILE);
+        if (!base) {
+            fprintf(stderr, "No %s to update, run inverted first\n", INDEX_FILE);
+            exit(1);
+        }
+        m = newManifest(nDocs(base));
+        closeIndex(base);
+    }
+    Index current = openSegments(m, m->gens, m->nSegments);
+    if (!current || docTableSize(current) != m->nDocs) {
+        fprintf(stderr, "Could not open the index segments listed in %s, run inverted to rebuild the index\n", INDEX_MANIFEST);
+        exit(1);
+    }
+    HashTable docIDs = newHashTable(m->nDocs + nURLs); //url -> document ID, the same as the index's since they are added in ID order
+    for (int d = 0; d < m->nDocs; d++) getID(docIDs, docURL(current, d));
+    closeIndex(current);
+    URLQueue collection = getURLS();
+    HashTable inCollection = getURLIDs(collection);
+
+    int *ids = malloc(nURLs*sizeof(int)), nIds = 0;
+    assert(ids);
+    for (int i = 0; i < nURLs; i++) {
+        int id = findID(docIDs, urls[i]);
+        if (findID(inCollection, urls[i]) == NOT_FOUND) {
+            if (id != NOT_FOUND) m->owner[id] = DELETED;
+            continue;
+        }
+        if (id == NOT_FOUND) {
+            id = getID(docIDs, urls[i]);
+            if (m->nDocs == m->maxDocs) {
+                m->maxDocs *= 2;
+                m->owner = realloc(m->owner, m->maxDocs*sizeof(int));
+                assert(m->owner);
+            }
+            m->owner[m->nDocs++] = DELETED; //until it has been read below
+        }
+        ids[nIds++] = id;
+    }
+    qsort(ids, nIds, sizeof(int), compareIDs); //the dictionary needs each word's documents to come in order
+    int unique = 0;
+    for (int i = 0; i < nIds; i++) if (unique == 0 || ids[i] != ids[unique-1]) ids[unique++] = ids[i];
+    nIds = unique;
+
+    if (nIds > 0) {
+        Dictionary dict = newDictionary();
+        int *lengths = calloc(m->nDocs, sizeof(int));
+        assert(lengths);
+        for (int i = 0; i < nIds; i++) readDocument(dict, keyOf(docIDs, ids[i]), ids[i], lengths);
+
+        int gen = m->nextGen++;
+        char fileName[MAX_LINE];
+        segmentFile(gen, fileName);
+        URLQueue table = newURLQueue();
+        for (int d = 0; d < m->nDocs; d++) newURLNode(keyOf(docIDs, d), table);
+        IndexWriter writer = newIndexWriter(fileName, table);
+        for (int i = 0; i < nIds; i++) setDocLength(writer, ids[i], lengths[ids[i]]);
+        int *order = sortTerms(dict);
+        for (int t = 0; t < dict->nTerms; t++) {
+            Postings *p = &dict->postings[order[t]];
+            addTerm(writer, keyOf(dict->terms, order[t]), p->n, p->docs, p->counts);
+        }
+        closeIndexWriter(writer);
+
+        for (int i = 0; i < nIds; i++) m->owner[ids[i]] = gen;
+        m->gens = realloc(m->gens, (m->nSegments+1)*sizeof(int));
+        assert(m->gens);
+        m->gens[m->nSegments++] = gen;
+        free(order); free(lengths);
+        freeURLQueue(table);
+        freeDictionary(dict);
+    }
+    writeManifest(INDEX_MANIFEST, m);
+    unlockFile(lock);
+
+    free(ids);
+    freeManifest(m);
+    disposeHashTable(docIDs); disposeHashTable(inCollection);
+    freeURLQueue(collection);
+    mergeInBackground();
+}
+
+/*
+Tiered merging: a segment's tier is set by how many live documents it holds, and whenever a tier has MERGE_FACTOR segments
+the oldest MERGE_FACTOR of them are merged into one, which usually lands in the next tier up. This repeats until no tier is full.
+The manifest is only locked to pick the segments and to swap the merged one in, so updates carry on during the merge.
+Documents updated while merging already belong to newer segments, so they keep them and their postings in the merged segment stay masked.
+With wait set it waits for a merge that is already running to finish first, otherwise it leaves the merging to that one.
+*/
+void mergeTiers(int wait) {
+    int mergeLock = lockFile(MERGE_LOCK, wait ? LOCK_EX : LOCK_EX | LOCK_NB);
+    if (mergeLock == -1) return;
+    while (1) {
+        int lock = lockFile(INDEX_LOCK, LOCK_EX);
+        Manifest m = readManifest(INDEX_MANIFEST);
+        int inputs[MERGE_FACTOR], n = m ? pickMerge(m, inputs) : 0;
+        if (n == 0) {
+            unlockFile(lock);
+            freeManifest(m);
+            break;
+        }
+        int gen = m->nextGen++;
+        writeManifest(INDEX_MANIFEST, m); //so no update takes the generation while the merge runs
+        unlockFile(lock);
+        compactSegments(m, inputs, n, gen);
+        freeManifest(m);
+
+        lock = lockFile(INDEX_LOCK, LOCK_EX);
+        m = readManifest(INDEX_MANIFEST);
+        assert(m); //full builds wait for the merge lock before removing the manifest
+        for (int d = 0; d < m->nDocs; d++) {
+            for (int i = 0; i < n; i++) if (m->owner[d] == inputs[i]) m->owner[d] = gen;
+        }
+        int kept = 0, placed = 0;
+        for (int s = 0; s < m->nSegments; s++) {
+            int merged = 0;
+            for (int i = 0; i < n; i++) merged |= m->gens[s] == inputs[i];
+            if (!merged) m->gens[kept++] = m->gens[s];
+            else if (!placed) { //where the oldest of them was
+                m->gens[kept++] = gen;
+                placed = 1;
+            }
+        }
+        m->nSegments = kept;
+        writeManifest(INDEX_MANIFEST, m);
+        unlockFile(lock);
+        for (int i = 0; i < n; i++) { //queries that already have them mapped keep reading them until they finish
+            char fileName[MAX_LINE];
+            segmentFile(inputs[i], fileName);
+            if (inputs[i] != 0) unlink(fileName); //INDEX_FILE stays, as it does in removeSegments, for the next full build or update to start from
+        }
+        freeManifest(m);
+    }
+    unlockFile(mergeLock);
+}
+
+//Removes the manifest and every segment but INDEX_FILE, once any merge has finished, ready for a full build
+void removeSegments() {
+    if (access(INDEX_MANIFEST, F_OK) != 0) return; //never updated since the last full build
+    int mergeLock = lockFile(MERGE_LOCK, LOCK_EX);
+    int lock = lockFile(INDEX_LOCK, LOCK_EX);
+    Manifest m = readManifest(INDEX_MANIFEST);
+    if (m) {
+        unlink(INDEX_MANIFEST);
+        for (int s = 0; s < m->nSegments; s++) {
+            char fileName[MAX_LINE];
+            segmentFile(m->gens[s], fileName);
+            if (m->gens[s] != 0) unlink(fileName);
+        }
+        freeManifest(m);
+    }
+    unlockFile(lock);
+    unlockFile(mergeLock);
+}
+
+//Opens and flocks a lock file, returning its descriptor, or -1 if how has LOCK_NB and someone else has it
+static int lockFile(char *fileName, int how) {
+    int fd = open(fileName, O_RDWR | O_CREAT, 0644);
+    assert(fd != -1);
+    if (flock(fd, how) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void unlockFile(int fd) {
+    flock(fd, LOCK_UN);
+    close(fd);
+}
+
+//The urls of every document ID in the index's document table, in ID order
+static URLQueue docTable(Index idx) {
+    URLQueue table = newURLQueue();
+    for (int d = 0; d < docTableSize(idx); d++) newURLNode(docURL(idx, d), table);
+    return table;
+}
+
+//Runs mergeTiers in a detached process so the update returns straight away
+static void mergeInBackground() {
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid == 0) { //the child forks the merge off and exits at once, so the merge isn't left a zombie
+        if (fork() == 0) {
+            setsid();
+            if (!freopen("/dev/null", "r", stdin) || !freopen("/dev/null", "w", stdout)) _exit(1); //nor holds on to a pipe the caller is reading
+            mergeTiers(0);
+        }
+        _exit(0);
+    }
+    if (pid > 0) waitpid(pid, NULL, 0);
+}
+
+//Puts the generations of the oldest MERGE_FACTOR segments of the lowest full tier in inputs, returning how many (0 if no tier is full)
+static int pickMerge(Manifest m, int *inputs) {
+    int *live = calloc(m->nSegments, sizeof(int)), *tier = calloc(m->nSegments, sizeof(int));
+    assert(live && tier);
+    for (int d = 0; d < m->nDocs; d++) {
+        for (int s = 0; s < m->nSegments; s++) if (m->owner[d] == m->gens[s]) live[s]++;
+    }
+    int top = 0;
+    for (int s = 0; s < m->nSegments; s++) {
+        for (long limit = TIER_DOCS; live[s] >= limit; limit *= MERGE_FACTOR) tier[s]++;
+        if (tier[s] > top) top = tier[s];
+    }
+    int n = 0;
+    for (int t = 0; t <= top && n < MERGE_FACTOR; t++) {
+        n = 0;
+        for (int s = 0; s < m->nSegments && n < MERGE_FACTOR; s++) if (tier[s] == t) inputs[n++] = m->gens[s];
+    }
+    free(live); free(tier);
+    return n == MERGE_FACTOR ? n : 0;
+}
+
+//Writes the live postings of the segments with generations inputs, as of manifest m, into one new segment with generation gen
+static void compactSegments(Manifest m, int *inputs, int n, int gen) {
+    Index merging = openSegments(m, inputs, n);
+    assert(merging);
+    char fileName[MAX_LINE];
+    segmentFile(gen, fileName);
+    URLQueue table = docTable(merging);
+    IndexWriter writer = newIndexWriter(fileName, table);
+    for (int d = 0; d < docTableSize(merging); d++) setDocLength(writer, d, docLength(merging, d)); //0 for documents they don't own
+
+    int max = MIN_POSTINGS;
+    int *docs = malloc(max*sizeof(int)), *counts = malloc(max*sizeof(int));
+    assert(docs && counts);
+    for (int t = firstTerm(merging); t != NOT_FOUND; t = nextTerm(merging, t)) {
+        if (termDocs(merging, t) > max) {
+            while (termDocs(merging, t) > max) max *= 2;
+            docs = realloc(docs, max*sizeof(int));
+            counts = realloc(counts, max*sizeof(int));
+            assert(docs && counts);
+        }
+        int k = getPostings(merging, t, docs, counts);
+        if (k > 0) addTerm(writer, termAt(merging, t), k, docs, counts); //words only in documents updated since are dropped
+    }
+    closeIndexWriter(writer);
+    free(docs); free(counts);
+    freeURLQueue(table);
+    closeIndex(merging);
+}
+
+static int compareIDs(const void *a, const void *b) {
+    return *(int *)a - *(int *)b;
+}
@@ -7,45 +7,121 @@
 #include <string.h>
 #include <math.h>
 #include <assert.h>
-#include "graph.h"
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include "sparseGraph.h"
+#include "pagerank.h"
 #include "URL.h"
 #include "utility.h"
 
-typedef enum { In, Out } LinkType; //a definition of link types for clarity and the validation of parameters
+#define MIN_EDGES 1024
 
-void calculatePageRank(double,double,int);
-double getWeightedLinkValues(double[],Graph,char*);
-double getLinks(LinkType,char*,Graph);
-double getLinksReferencedBy(LinkType,char*,Graph);
-void outputPageRanks(double[],Graph);
+typedef struct _rankedVertex { //a vertex's place in pagerankList.txt
+	double pageRank;
+	int id;
+} RankedVertex;
+
+typedef struct _edgeList *EdgeList;
+
+struct _edgeList { //edges gathered while reading the url files, before the graph is built in one go
+	int nE;
+	int maxE;
+	int *src;
+	int *dest;
+};
+
+void calculatePageRank(double,double,int,PageRankOptions*);
+void streamPageRank(double,double,int,PageRankOptions*);
+void batchPageRank(double,double,int,PageRankOptions*);
+void outputPageRanks(char*,double[],int,HashTable,int[]);
+void outputScoreTable(double[],HashTable);
 
 int main(int argc, char *argv[]) {
-	if (argc != 4) {
-		fprintf(stderr, "Usage: <dampening> <minDiff> <maxIterations>\n");
+	PageRankOptions options = { .threads = 0, .solver = Jacobi, .showStats = 0, .order = NoOrder, .singlePrecision = 0, .snapshot = NULL, .dampenings = NULL, .seedFile = NULL, .edgeFile = NULL };
+	int solverGiven = 0;
+	int badOption = argc < 4;
+	for (int i = 4; i < argc && !badOption; i++) {
+		if (strEQ(argv[i], "-t") && i+1 < argc) options.threads = atoi(argv[++i]); //-t <threads> reads the url files and iterates with a pool of threads
+		else if (strEQ(argv[i], "-s") && i+1 < argc) { //-s <solver> picks how to iterate, and reports how much work it took
+			i++;
+			options.showStats = solverGiven = 1;
+			if (strEQ(argv[i], "jacobi")) options.solver = Jacobi;
+			else if (strEQ(argv[i], "gs")) options.solver = GaussSeidel;
+			else if (strEQ(argv[i], "push")) options.solver = Push;
+			else if (strEQ(argv[i], "simd")) options.solver = Vectorised;
+			else badOption = 1;
+		}
+		else if (strEQ(argv[i], "-o") && i+1 < argc) { //-o <ordering> relabels the pages so linked ones sit together in memory
+			i++;
+			if (strEQ(argv[i], "degree")) options.order = DegreeOrder;
+			else if (strEQ(argv[i], "bfs")) options.order = BFSOrder;
+			else if (strEQ(argv[i], "rcm")) options.order = RCMOrder;
+			else badOption = 1;
+		}
+		else if (strEQ(argv[i], "-w") && i+1 < argc) options.snapshot = argv[++i]; //-w <snapshot> warm starts from the last run
+		else if (strEQ(argv[i], "-f")) options.singlePrecision = 1; //-f runs the simd solver in single precision
+		else if (strEQ(argv[i], "-d") && i+1 < argc) options.dampenings = argv[++i]; //-d <d1,d2,...> finds a pagerank vector per dampening in one go
+		else if (strEQ(argv[i], "-p") && i+1 < argc) options.seedFile = argv[++i]; //-p <seedFile> and a vector per set of seed urls
+		else if (strEQ(argv[i], "-e") && i+1 < argc) options.edgeFile = argv[++i]; //-e <edgeFile> streams the links from disk
+		else badOption = 1;
+	}
+	if (options.snapshot && !solverGiven && options.threads == 0) options.solver = Push; //push only does work where the graph changed
+	if (options.threads > 0 && options.solver != Jacobi) badOption = 1; //only the jacobi loop has a parallel version
+	if (options.singlePrecision && options.solver != Vectorised) badOption = 1;
+	if (options.edgeFile && (options.threads > 0 || options.solver != Jacobi || options.snapshot || options.order != NoOrder)) badOption = 1; //or a streaming one
+	if ((options.dampenings || options.seedFile) && (options.threads > 0 || options.solver != Jacobi || options.snapshot || options.order != NoOrder || options.edgeFile)) badOption = 1; //or a batched one
+	if (badOption) {
+		fprintf(stderr, "Usage: <dampening> <minDiff> <maxIterations> [-t <threads>] [-s jacobi|gs|push|simd [-f]] [-o degree|bfs|rcm] [-w <snapshot>] [-e <edgeFile>] [-d <d1,d2,...>] [-p <seedFile>]\n");
 		return 1;
 	}
-	calculatePageRank(atof(argv[1]), atof(argv[2]), atoi(argv[3]));
+	if (options.dampenings || options.seedFile) batchPageRank(atof(argv[1]), atof(argv[2]), atoi(argv[3]), &options);
+	else if (options.edgeFile) streamPageRank(atof(argv[1]), atof(argv[2]), atoi(argv[3]), &options);
+	else calculatePageRank(atof(argv[1]), atof(argv[2]), atoi(argv[3]), &options);
 	return 0;
 }
 
-//Goes through "arr" with given "size" and returns the index of the largest element
-int getLargest(double arr[], int size) {
-	double currLargest = 0; int currIndex = 0;
-	for (int i = 0; i < size; i++) {
-		if (arr[i] > currLargest) {
-			currLargest = arr[i];
-			currIndex = i;
-		}
+//Orders vertices by pagerank, largest first, with ties going to the lower vertex ID
+static int compareRanks(const void *element1, const void *element2) {
+	const RankedVertex *v1 = element1, *v2 = element2;
+	if (v1->pageRank != v2->pageRank) return v1->pageRank < v2->pageRank ? 1 : -1;
+	return v1->id - v2->id;
+}
+
+/*
+Adds an edge from the url "from" to the url "to", giving either url a vertex ID if it doesn't have one yet.
+As with the old adjacency matrix there is room for at most maxV vertices; links that would need more are dropped.
+*/
+static void addLink(HashTable names, EdgeList edges, char *from, char *to, int maxV) {
+	int v = findID(names, from);
+	if (v == NOT_FOUND) {
+		if (nKeys(names) >= maxV) return;
+		v = getID(names, from);
 	}
-	return currIndex;
+	int w = findID(names, to);
+	if (w == NOT_FOUND) {
+		if (nKeys(names) >= maxV) return;
+		w = getID(names, to);
+	}
+	if (edges->nE == edges->maxE) {
+		edges->maxE *= 2;
+		edges->src = realloc(edges->src, edges->maxE*sizeof(int));
+		edges->dest = realloc(edges->dest, edges->maxE*sizeof(int));
+		assert(edges->src && edges->dest);
+	}
+	edges->src[edges->nE] = v;
+	edges->dest[edges->nE++] = w;
 }
 
 /*
 Goes through every URL file in the given queue and reads section 1 to find its outlinks.
 Each outlink represents a directed edge from the current url to the url linked to.
+Vertex IDs are handed out in the order urls first appear in an edge, the same order the old Graph ADT gave them.
 */
-Graph getGraph(URLQueue urls) {
-	Graph graph = newGraph(urls->len); //create an empty graph with max vertices equal to the numbers of urls
+SparseGraph getGraph(URLQueue urls) {
+	HashTable names = newHashTable(urls->len); //url -> vertex ID
+	struct _edgeList edges = { 0, MIN_EDGES, malloc(MIN_EDGES*sizeof(int)), malloc(MIN_EDGES*sizeof(int)) };
+	assert(edges.src && edges.dest);
 	char buffer[MAX_LINE], *link;
 	URLNode mover = urls->head;
 	while (mover) {
@@ -58,99 +134,244 @@ Graph getGraph(URLQueue urls) {
 
 			link = strtok(buffer, " \n"); //splits the buffer on any number of spaces and newlines - meaning empty lines will be disregarded
 			while (link) { //since link points to the split buffer
-				if (!strEQ(mover->URL, link)) addEdge(graph, mover->URL, link); //add an edge from the current url to its link ensuring no self-loops (duplicates handled by ADT)
+				if (!strEQ(mover->URL, link)) addLink(names, &edges, mover->URL, link, urls->len); //add an edge from the current url to its link ensuring no self-loops (duplicates handled by ADT)
 				link = strtok(NULL, " \n"); //get the next part of the split buffer
 			}
 		}
 		mover = mover->next;
 		fclose(fp);
 	}
+	SparseGraph graph = newSparseGraph(names, edges.nE, edges.src, edges.dest);
+	free(edges.src); free(edges.dest);
 	return graph;
 }
 
 /***********************************************
-create arrays to store the current and previous iterations pageranks
-initialise the pageranks via the formula because it's iteration 0
-
-for iterations going from 0 to maxIterations
-	if the difference of the pageranks for this iteration is >= to the minimumDifference
-		exit
-	otherwise
-		copy over the previous iterations pageranks
-		calculate this iterations pageranks for all urls
-		calculate the aggregate difference in pageranks between this iteration and the previous
-
-output the pageranks
+build the graph, relabel its vertices if asked to, and work out the weight of every link once
+initialise the pageranks via the formula because it's iteration 0, or from the last run when warm starting
+iterate until the pageranks change by less than minDiff or maxIterations is reached
+
+output the pageranks in collection order, as pagerankList.txt and the score table (and save a snapshot for the next warm start)
 free associated memory
 ***********************************************/
-void calculatePageRank(double dampening, double minDiff, int maxIterations) {
+void calculatePageRank(double dampening, double minDiff, int maxIterations, PageRankOptions *options) {
 	URLQueue urls = getURLS(); //get all the urls in collection.txt
-	Graph g = getGraph(urls); freeURLQueue(urls);
-	double diff = minDiff;
-	double *pageRanks = calloc(g->nV, sizeof(double)), *prevRanks = calloc(g->nV, sizeof(double));
+	SparseGraph original = options->threads > 0 ? getGraphParallel(urls, options->threads) : getGraph(urls); freeURLQueue(urls);
+	SparseGraph g = original; //the graph that gets iterated over
+	int *newID = NULL;
+	if (options->order != NoOrder) {
+		newID = findOrdering(original, options->order);
+		g = reorderGraph(original, newID);
+	}
+	LinkWeights w = newLinkWeights(g);
+	double *pageRanks = calloc(g->nV, sizeof(double));
 	for (int i = 0; i < g->nV; i++) pageRanks[i] = (double)1/g->nV; //initlaise the pageranks in the base iteration
-
-	for (int iteration = 0; iteration < maxIterations && diff >= minDiff; iteration++) {
-		for (int i = 0; i < g->nV; i++) prevRanks[i] = pageRanks[i]; //copy over the previous iterations pageranks
-		for (int i = 0; i < g->nV; i++) {
-			pageRanks[i] = (double)(1-dampening)/g->nV + dampening*getWeightedLinkValues(prevRanks, g, g->vertex[i]); //calculate the pageranks for this iteration
+	double *residual = NULL;
+	if (options->snapshot) {
+		residual = malloc((g->nV > 0 ? g->nV : 1)*sizeof(double)); assert(residual);
+		int affected = warmStart(g, w, dampening, options->snapshot, pageRanks, residual);
+		if (affected == NOT_FOUND) { free(residual); residual = NULL; } //nothing to diff against, so the solver works out every residual
+		if (options->showStats) {
+			if (affected == NOT_FOUND) fprintf(stderr, "no usable snapshot, all %d vertices affected\n", g->nV);
+			else fprintf(stderr, "%d of %d vertices affected\n", affected, g->nV);
 		}
-		diff = 0;
-		for (int i = 0; i < g->nV; i++) diff += fabs(pageRanks[i] - prevRanks[i]); //find the difference between the new pageranks and the old ones
 	}
+
+	SolverStats stats;
+	if (options->solver == GaussSeidel) stats = iteratePageRankGaussSeidel(w, dampening, minDiff, maxIterations, pageRanks);
+	else if (options->solver == Push) stats = iteratePageRankPush(w, dampening, minDiff, maxIterations, pageRanks, residual);
+	else if (options->solver == Vectorised) stats = iteratePageRankVectorised(w, dampening, minDiff, maxIterations, pageRanks, options->singlePrecision, 1);
+	else if (options->threads > 0) stats = iteratePageRankParallel(w, dampening, minDiff, maxIterations, pageRanks, options->threads);
+	else stats = iteratePageRank(w, dampening, minDiff, maxIterations, pageRanks);
+	if (options->showStats) fprintf(stderr, "%d iterations, %ld edges processed\n", stats.iterations, stats.edges);
+	if (options->showStats && options->solver == Vectorised) fprintf(stderr, "%s kernel, %s precision\n", haveAVX2Kernel() ? "avx2" : "scalar", options->singlePrecision ? "single" : "double");
+	if (options->snapshot) saveSnapshot(g, dampening, pageRanks, options->snapshot); //before output, which overwrites the pageranks
 	
-	outputPageRanks(pageRanks, g);
-	free(pageRanks); free(prevRanks);
+	if (newID) { //put the pageranks back in collection order, so ties come out in the same order as without reordering
+		double *reordered = pageRanks;
+		pageRanks = malloc((g->nV > 0 ? g->nV : 1)*sizeof(double)); assert(pageRanks);
+		for (int i = 0; i < g->nV; i++) pageRanks[i] = reordered[newID[i]];
+		free(reordered); free(newID);
+		freeLinkWeights(w); w = NULL;
+		disposeSparseGraph(g); g = original;
+	}
+
+	int *outLinks = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int)); assert(outLinks);
+	for (int i = 0; i < g->nV; i++) outLinks[i] = (int)getLinks(Out, i, g);
+	outputPageRanks("pagerankList.txt", pageRanks, g->nV, g->names, outLinks);
+	outputScoreTable(pageRanks, g->names);
+	free(pageRanks); free(residual); free(outLinks);
+	if (w) freeLinkWeights(w);
+	disposeSparseGraph(g);
 }
 
-/*
-This represents the sigma term in the equation 
-It goes through all urls to find those that link to the subjectURL (p(i))
-If it finds one then it adds the product of WIn, WOut and previous pagerank to the total
-*/
-double getWeightedLinkValues(double prevRanks[], Graph g, char *subjectURL) {
-	double total = 0, WIn = 0, WOut = 0;
-	for (int i = 0; i < g->nV; i++) {
-		if (isConnected(g, g->vertex[i], subjectURL)) { //finding p(j) in M(p(i))
-			WIn = (double)getLinks(In, subjectURL, g)/getLinksReferencedBy(In, g->vertex[i], g); //inlinks to p(i)/(sum of inlinks of nodes with inlinks from p(j))
-			WOut = (double)getLinks(Out, subjectURL, g)/getLinksReferencedBy(Out, g->vertex[i], g); //as above but replacing inlinks for outlinks
-			total += prevRanks[i]*WIn*WOut;
-		}
+/***********************************************
+if there is no edge file yet, or the url files have changed since it was written, build the graph from the url files once and write it out, then let the graph go
+iterate jacobi style with the links streamed from the edge file, so only the pagerank vectors are held in memory
+read the url names and outlinks back from the end of the edge file and output the pageranks and score table
+
+Peak memory use is reported on stderr. Once the edge file exists it stays O(V);
+a run that has to write the edge file first still holds the whole graph while doing so.
+***********************************************/
+void streamPageRank(double dampening, double minDiff, int maxIterations, PageRankOptions *options) {
+	unsigned long long stamp = sourceStamp(); //taken before the url files are read, so an edge file built from ones changed meanwhile won't match next time
+	EdgeFile ef = openEdgeFile(options->edgeFile, stamp);
+	if (!ef) {
+		URLQueue urls = getURLS();
+		SparseGraph g = getGraph(urls); freeURLQueue(urls);
+		LinkWeights w = newLinkWeights(g);
+		writeEdgeFile(g, w, options->edgeFile, stamp);
+		freeLinkWeights(w);
+		disposeSparseGraph(g);
+		ef = openEdgeFile(options->edgeFile, stamp); assert(ef);
 	}
-	return total;
+	double *pageRanks = malloc((ef->nV > 0 ? ef->nV : 1)*sizeof(double)); assert(pageRanks);
+	for (int i = 0; i < ef->nV; i++) pageRanks[i] = (double)1/ef->nV;
+	SolverStats stats = iteratePageRankStream(ef, dampening, minDiff, maxIterations, pageRanks);
+
+	int *outLinks = malloc((ef->nV > 0 ? ef->nV : 1)*sizeof(int)); assert(outLinks);
+	HashTable names = readVertexTable(ef, outLinks);
+	outputPageRanks("pagerankList.txt", pageRanks, ef->nV, names, outLinks);
+	outputScoreTable(pageRanks, names);
+
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	fprintf(stderr, "%d iterations, %ld edges streamed, peak RSS %ld KB\n", stats.iterations, stats.edges, usage.ru_maxrss);
+	free(pageRanks); free(outLinks);
+	disposeHashTable(names);
+	closeEdgeFile(ef);
 }
 
-//Goes through every node to find the number of inlinks or outlinks to the node
-double getLinks(LinkType type, char *url, Graph g) {
-	int total = 0, isInLinks = type == In;
-	for (int i = 0; i < g->nV; i++) {
-		if (isInLinks ? isConnected(g, g->vertex[i], url) : isConnected(g, url, g->vertex[i])) { //handling different link direction for inlinks and outlinks
-			total += 1;
+/***********************************************
+build the graph and work out the weight of every link once
+set up one pagerank vector per dampening in the -d list (teleporting anywhere),
+then one per line of the seed file (teleporting only to that line's urls, with the given dampening)
+iterate all of them together, one pass over the links per iteration
+
+output vector k's pageranks to pagerankList-k.txt, numbering from 1 in the order above
+***********************************************/
+void batchPageRank(double dampening, double minDiff, int maxIterations, PageRankOptions *options) {
+	URLQueue urls = getURLS();
+	SparseGraph g = getGraph(urls); freeURLQueue(urls);
+	LinkWeights w = newLinkWeights(g);
+	int nVectors = 0, maxVectors = 4;
+	double *dampenings = malloc(maxVectors*sizeof(double)); assert(dampenings);
+	char **seeds = calloc(maxVectors, sizeof(char*)); assert(seeds); //the seed line of each vector, NULL to teleport anywhere
+	char buffer[MAX_LINE], *token, *rest;
+
+	if (options->dampenings) {
+		char *list = strdup(options->dampenings);
+		for (token = strtok_r(list, ",", &rest); token; token = strtok_r(NULL, ",", &rest)) {
+			if (nVectors == maxVectors) {
+				maxVectors *= 2;
+				dampenings = realloc(dampenings, maxVectors*sizeof(double)); seeds = realloc(seeds, maxVectors*sizeof(char*)); assert(dampenings && seeds);
+			}
+			seeds[nVectors] = NULL;
+			dampenings[nVectors++] = atof(token);
 		}
+		free(list);
+	}
+	if (options->seedFile) {
+		FILE *fp = fopen(options->seedFile, "r"); assert(fp);
+		while (fgets(buffer, MAX_LINE, fp)) {
+			if (strspn(buffer, " \n") == strlen(buffer)) continue; //blank lines don't make a vector
+			if (nVectors == maxVectors) {
+				maxVectors *= 2;
+				dampenings = realloc(dampenings, maxVectors*sizeof(double)); seeds = realloc(seeds, maxVectors*sizeof(char*)); assert(dampenings && seeds);
+			}
+			seeds[nVectors] = strdup(buffer);
+			dampenings[nVectors++] = dampening;
+		}
+		fclose(fp);
 	}
-	return isInLinks ? total : (total == 0 ? 0.5 : total); //if it's for inlinks or (outlinks and the total is not 0), return the total, otherwise return 0.5
-}
 
-//Goes through every node to find ones that the referer links to and gets their inlinks or outlinks
-double getLinksReferencedBy(LinkType type, char *referer, Graph g) {
-	double total = 0;
-	for (int i = 0; i < g->nV; i++) {
-		if (isConnected(g, referer, g->vertex[i])) { //nodes linked to by the current referer of p(i)
-			total += getLinks(type, g->vertex[i], g); //sum the inlinks or outlinks of the referred nodes
+	long size = (long)g->nV*nVectors;
+	double *pageRanks = malloc((size > 0 ? size : 1)*sizeof(double)), *base = calloc(size > 0 ? size : 1, sizeof(double));
+	int *isSeed = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int));
+	assert(pageRanks && base && isSeed);
+	for (long i = 0; i < size; i++) pageRanks[i] = (double)1/g->nV;
+	for (int k = 0; k < nVectors; k++) {
+		int nSeeds = 0;
+		for (int i = 0; i < g->nV; i++) isSeed[i] = 0;
+		if (seeds[k]) {
+			for (token = strtok_r(seeds[k], " \n", &rest); token; token = strtok_r(NULL, " \n", &rest)) {
+				int v = findID(g->names, token);
+				if (v != NOT_FOUND && !isSeed[v]) { isSeed[v] = 1; nSeeds++; }
+			}
+			if (nSeeds == 0) fprintf(stderr, "pagerankList-%d.txt: none of its seed urls are in the graph, teleporting anywhere\n", k+1);
+		}
+		for (int i = 0; i < g->nV; i++) {
+			if (nSeeds == 0) base[(long)i*nVectors + k] = (double)(1-dampenings[k])/g->nV;
+			else if (isSeed[i]) base[(long)i*nVectors + k] = (double)(1-dampenings[k])/nSeeds;
 		}
 	}
-	return total;
-}	
 
-//Goes through the pageranks array and finds the next largest value to output
-void outputPageRanks(double pageRanks[], Graph g) {
-	FILE *fp = fopen("pagerankList.txt", "w"); assert(fp);
-	int largest;
-	for (int i = 0; i < g->nV; i++) {
-		largest = getLargest(pageRanks, g->nV);
-		fprintf(fp, "%s, %d, %.7lf\n", g->vertex[largest], (int)getLinks(Out, g->vertex[largest], g), pageRanks[largest]);
-		pageRanks[largest] = -1; /*after finding the current largest we should set it to a small value so that we can find the next largest.
-								   -1 is valid for this because pageranks cannot be negative by calculation (i can prove this if you like)*/
+	SolverStats stats = iteratePageRankBatch(w, nVectors, dampenings, base, minDiff, maxIterations, pageRanks);
+	if (options->showStats) fprintf(stderr, "%d vectors, %d iterations, %ld edges processed\n", nVectors, stats.iterations, stats.edges);
+
+	double *vector = malloc((g->nV > 0 ? g->nV : 1)*sizeof(double));
+	int *outLinks = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int));
+	assert(vector && outLinks);
+	for (int i = 0; i < g->nV; i++) outLinks[i] = (int)getLinks(Out, i, g);
+	for (int k = 0; k < nVectors; k++) {
+		char fileName[MAX_LINE];
+		sprintf(fileName, "pagerankList-%d.txt", k+1);
+		for (int i = 0; i < g->nV; i++) vector[i] = pageRanks[(long)i*nVectors + k];
+		outputPageRanks(fileName, vector, g->nV, g->names, outLinks);
+		free(seeds[k]);
+	}
+	free(vector); free(outLinks); free(isSeed);
+	free(pageRanks); free(base); free(dampenings); free(seeds);
+	freeLinkWeights(w);
+	disposeSparseGraph(g);
+}
+
+//Sorts the vertices by pagerank (ties in vertex ID order) and outputs each with its url and number of outlinks
+void outputPageRanks(char *fileName, double pageRanks[], int nV, HashTable names, int outLinks[]) {
+	FILE *fp = fopen(fileName, "w"); assert(fp);
+	RankedVertex *ranked = malloc((nV > 0 ? nV : 1)*sizeof(RankedVertex)); assert(ranked);
+	for (int i = 0; i < nV; i++) ranked[i] = (RankedVertex){ pageRanks[i], i };
+	qsort(ranked, nV, sizeof(RankedVertex), compareRanks);
+	for (int i = 0; i < nV; i++) {
+		int v = ranked[i].id;
+		fprintf(fp, "%s, %d, %.7lf\n", keyOf(names, v), outLinks[v], pageRanks[v]);
 	}
+	free(ranked);
 	fclose(fp);
-}
\ No newline at end of file
+}
+
+/*
+Writes SCORE_TABLE: SCORE_TABLE_MAGIC, the number of urls in collection.txt, its size and modification time, then a pagerank for each url by document ID
+(its place in collection.txt), so searchPagerank can look a url's pagerank up directly.
+Urls that aren't in the graph get 0, as they have no line in pagerankList.txt.
+Each pagerank is stored as it reads in pagerankList.txt (to 7 places) so searches rank pages exactly as they would from the list.
+*/
+void outputScoreTable(double pageRanks[], HashTable names) {
+	URLQueue urls = getURLS();
+	FILE *fp = fopen(SCORE_TABLE ".tmp", "wb"); assert(fp); //renamed into place once written, as searchServer may have the old one mapped
+	int header[2] = { SCORE_TABLE_MAGIC, urls->len };
+	long long collection[2] = { -1, -1 };
+	struct stat st;
+	if (stat("collection.txt", &st) == 0) {
+		collection[0] = st.st_size;
+		collection[1] = st.st_mtim.tv_sec*1000000000LL + st.st_mtim.tv_nsec;
+	}
+	fwrite(header, sizeof(int), 2, fp);
+	fwrite(collection, sizeof(long long), 2, fp);
+	char rounded[MAX_LINE];
+	for (URLNode curr = urls->head; curr; curr = curr->next) {
+		int v = findID(names, curr->URL);
+		double pageRank = 0;
+		if (v != NOT_FOUND) {
+			sprintf(rounded, "%.7lf", pageRanks[v]);
+			pageRank = atof(rounded);
+		}
+		fwrite(&pageRank, sizeof(double), 1, fp);
+	}
+	if (ferror(fp) | fclose(fp) || rename(SCORE_TABLE ".tmp", SCORE_TABLE) != 0) {
+		perror(SCORE_TABLE);
+		unlink(SCORE_TABLE ".tmp");
+		exit(1);
+	}
+	freeURLQueue(urls);
+}
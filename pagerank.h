@@ -0,0 +1,75 @@
+#ifndef PAGERANK_H
+#define PAGERANK_H
+
+#include "sparseGraph.h"
+#include "URL.h"
+
+typedef enum { In, Out } LinkType; //a definition of link types for clarity and the validation of parameters
+
+typedef struct _linkWeights *LinkWeights;
+
+struct _linkWeights { //everything an iteration needs, worked out once from the graph
+	int nV;
+	int nE;
+	int *inStart; //in-edges of v are inSrc[inStart[v]] .. inSrc[inStart[v+1]-1] (shared with the graph)
+	int *inSrc;
+	double *wIn; //WIn of each in-edge
+	double *wOut; //WOut of each in-edge
+	int *outStart; //out-edges of v are outDest[outStart[v]] .. outDest[outStart[v+1]-1] (shared with the graph)
+	int *outDest;
+	double *outWeight; //WIn*WOut of each out-edge, only worked out once a solver needs to push along out-edges
+};
+
+typedef struct _edgeFile *EdgeFile;
+
+struct _edgeFile { //a link graph on disk for streaming pagerank, see pagerankStream.c
+	FILE *fp;
+	int nV;
+	int nE;
+};
+
+typedef enum { Jacobi, GaussSeidel, Push, Vectorised } SolverType;
+
+typedef enum { NoOrder, DegreeOrder, BFSOrder, RCMOrder } VertexOrder; //how to relabel the vertices before iterating, see pagerankOrder.c
+
+typedef struct _pageRankOptions { //how pagerank should go about iterating, from the command line
+	int threads; //0 runs the original single-threaded loop, otherwise builds the graph and runs the blocked parallel loop with this many threads
+	SolverType solver;
+	int showStats; //report iterations and edges processed on stderr
+	VertexOrder order;
+	int singlePrecision; //the vectorised solver keeps pageranks and weights as floats
+	char *snapshot; //warm start from (and then update) this snapshot of the last run, or NULL to start from 1/nV
+	char *dampenings; //comma separated dampenings to find a pagerank vector for each of in one batch, or NULL
+	char *seedFile; //a file of seed url sets, one per line, to find a teleport-to-seeds pagerank vector for each of in the same batch, or NULL
+	char *edgeFile; //stream the links from this edge file (writing it first if need be) rather than holding the graph in memory, or NULL
+} PageRankOptions;
+
+typedef struct _solverStats {
+	int iterations; //full passes for jacobi and gauss-seidel, rounds of pushes for push
+	long edges; //edges processed altogether
+} SolverStats;
+
+LinkWeights newLinkWeights(SparseGraph);
+void freeLinkWeights(LinkWeights);
+double getLinks(LinkType,int,SparseGraph);
+double getLinksReferencedBy(LinkType,int,SparseGraph);
+SolverStats iteratePageRank(LinkWeights,double,double,int,double[]);
+SolverStats iteratePageRankGaussSeidel(LinkWeights,double,double,int,double[]);
+SolverStats iteratePageRankPush(LinkWeights,double,double,int,double[],double[]);
+SolverStats iteratePageRankParallel(LinkWeights,double,double,int,double[],int);
+SparseGraph getGraphParallel(URLQueue,int);
+int warmStart(SparseGraph,LinkWeights,double,char*,double[],double[]);
+void saveSnapshot(SparseGraph,double,double[],char*);
+unsigned long long sourceStamp();
+void writeEdgeFile(SparseGraph,LinkWeights,char*,unsigned long long);
+EdgeFile openEdgeFile(char*,unsigned long long);
+void closeEdgeFile(EdgeFile);
+SolverStats iteratePageRankStream(EdgeFile,double,double,int,double[]);
+HashTable readVertexTable(EdgeFile,int[]);
+SolverStats iteratePageRankVectorised(LinkWeights,double,double,int,double[],int,int);
+int haveAVX2Kernel();
+SolverStats iteratePageRankBatch(LinkWeights,int,double[],double[],double,int,double[]);
+int *findOrdering(SparseGraph,VertexOrder);
+SparseGraph reorderGraph(SparseGraph,int[]);
+
+#endif
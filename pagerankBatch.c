@@ -0,0 +1,55 @@
+//Batched PageRank: several pagerank vectors (different dampenings or teleport sets) found in one pass over the links per iteration
+//The vectors' values for a vertex sit next to each other, so each edge is read once and the per-vector work is a short loop the compiler vectorises
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "pagerank.h"
+
+/***********************************************
+pageRanks and base hold nVectors values per vertex: vector k's value for vertex i is at [i*nVectors + k]
+base is each vector's teleport term (1-d)/nV for plain pagerank, or (1-d)/|seeds| on its seed pages and 0 elsewhere
+
+for iterations going from 0 to maxIterations while any vector still changed by >= minDiff
+	copy over the previous iterations pageranks
+	for each vertex, go through its in-edges once, adding prev pagerank of p(j) * WIn * WOut into every vector's sigma term
+	calculate this iterations pageranks for every vector that hasn't settled yet
+	a vector whose pageranks changed by less than minDiff altogether is settled and left as it is
+
+Vectors stop on the same rule as iteratePageRank and the arithmetic is done in the same order,
+so each vector comes out exactly as a run of its own would.
+returns the iterations run (by the last vector to settle) and edges processed
+***********************************************/
+SolverStats iteratePageRankBatch(LinkWeights w, int nVectors, double dampenings[], double base[], double minDiff, int maxIterations, double pageRanks[]) {
+	int k, nActive = nVectors, iteration = 0;
+	long size = (long)w->nV*nVectors;
+	double *prevRanks = malloc((size > 0 ? size : 1)*sizeof(double)), *total = malloc(nVectors*sizeof(double)), *diff = malloc(nVectors*sizeof(double));
+	char *active = malloc(nVectors);
+	assert(prevRanks && total && diff && active);
+	for (k = 0; k < nVectors; k++) active[k] = 1;
+
+	for (; iteration < maxIterations && nActive > 0; iteration++) {
+		memcpy(prevRanks, pageRanks, size*sizeof(double));
+		for (k = 0; k < nVectors; k++) diff[k] = 0;
+		for (int i = 0; i < w->nV; i++) {
+			for (k = 0; k < nVectors; k++) total[k] = 0;
+			for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) {
+				double *prev = &prevRanks[(long)w->inSrc[e]*nVectors], wIn = w->wIn[e], wOut = w->wOut[e];
+				for (k = 0; k < nVectors; k++) total[k] += prev[k]*wIn*wOut;
+			}
+			double *ranks = &pageRanks[(long)i*nVectors], *prev = &prevRanks[(long)i*nVectors], *teleport = &base[(long)i*nVectors];
+			for (k = 0; k < nVectors; k++) {
+				if (!active[k]) continue;
+				ranks[k] = teleport[k] + dampenings[k]*total[k];
+				diff[k] += fabs(ranks[k] - prev[k]);
+			}
+		}
+		for (k = 0; k < nVectors; k++) {
+			if (active[k] && diff[k] < minDiff) { active[k] = 0; nActive--; }
+		}
+	}
+	free(prevRanks); free(total); free(diff); free(active);
+	return (SolverStats){ iteration, (long)iteration*w->nE };
+}
@@ -0,0 +1,164 @@
+//Builds the link graph with a pool of threads reading the url files
+//Each thread parses whole files into its own table of urls, then the edges are given their vertex IDs in one pass in collection order
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include "pagerank.h"
+#include "utility.h"
+
+#define MIN_LINKS 1024
+#define DROPPED -2 //a url that didn't get a vertex ID because the graph was already full
+
+typedef struct _fileLinks { //the outlinks read from one url file, as IDs in the reading thread's table
+	int thread;
+	int src;
+	int start; //links are links[start] .. links[end-1] of the reading thread
+	int end;
+} FileLinks;
+
+typedef struct _reader {
+	HashTable names; //url -> this thread's ID for it
+	int nLinks;
+	int maxLinks;
+	int *links;
+} Reader;
+
+typedef struct _buildPool {
+	char **urls; //the urls in collection order
+	int nFiles;
+	FileLinks *files;
+	Reader *readers;
+	pthread_mutex_t lock;
+	int nextFile; //the next file for a thread to take
+} BuildPool;
+
+typedef struct _buildWorker {
+	BuildPool *pool;
+	int id;
+} BuildWorker;
+
+static void *readerThread(void*);
+static void readLinks(BuildPool*,int,int);
+static int globalID(HashTable,Reader*,int*,int,int);
+
+/***********************************************
+start nThreads-1 readers; the calling thread is reader 0
+every reader takes the next unread file, parses section 1 and records the file's links with IDs from its own table
+
+once every file is read, go through the files in collection order and hand out vertex IDs to urls as they first
+appear in an edge, exactly as getGraph does, so the graph (and pagerankList.txt) are the same for any number of threads.
+Each url only needs looking up in the shared table the first time a reader's ID for it comes up.
+***********************************************/
+SparseGraph getGraphParallel(URLQueue urls, int nThreads) {
+	BuildPool pool = { .nFiles = urls->len, .nextFile = 0 };
+	nThreads = nThreads > 0 ? nThreads : 1;
+	pool.urls = malloc((pool.nFiles > 0 ? pool.nFiles : 1)*sizeof(char*));
+	pool.files = malloc((pool.nFiles > 0 ? pool.nFiles : 1)*sizeof(FileLinks));
+	pool.readers = malloc(nThreads*sizeof(Reader));
+	pthread_t *threads = malloc(nThreads*sizeof(pthread_t));
+	BuildWorker *workers = malloc(nThreads*sizeof(BuildWorker));
+	assert(pool.urls && pool.files && pool.readers && threads && workers);
+	int f = 0;
+	for (URLNode mover = urls->head; mover; mover = mover->next) pool.urls[f++] = mover->URL;
+	for (int t = 0; t < nThreads; t++) {
+		pool.readers[t] = (Reader){ newHashTable(urls->len/nThreads + 1), 0, MIN_LINKS, malloc(MIN_LINKS*sizeof(int)) };
+		assert(pool.readers[t].links);
+	}
+
+	pthread_mutex_init(&pool.lock, NULL);
+	for (int t = 0; t < nThreads; t++) workers[t] = (BuildWorker){ &pool, t };
+	for (int t = 1; t < nThreads; t++) pthread_create(&threads[t], NULL, readerThread, &workers[t]);
+	readerThread(&workers[0]);
+	for (int t = 1; t < nThreads; t++) pthread_join(threads[t], NULL);
+	pthread_mutex_destroy(&pool.lock);
+
+	long nLinks = 0;
+	int **globalOf = malloc(nThreads*sizeof(int*)); assert(globalOf); //globalOf[t][id] is the vertex ID of reader t's url id, NOT_FOUND if not looked up yet
+	for (int t = 0; t < nThreads; t++) {
+		int n = nKeys(pool.readers[t].names);
+		globalOf[t] = malloc((n > 0 ? n : 1)*sizeof(int)); assert(globalOf[t]);
+		for (int i = 0; i < n; i++) globalOf[t][i] = NOT_FOUND;
+		nLinks += pool.readers[t].nLinks;
+	}
+	HashTable names = newHashTable(urls->len); //url -> vertex ID
+	int *src = malloc((nLinks > 0 ? nLinks : 1)*sizeof(int)), *dest = malloc((nLinks > 0 ? nLinks : 1)*sizeof(int));
+	assert(src && dest);
+	int nE = 0;
+	for (f = 0; f < pool.nFiles; f++) {
+		FileLinks *file = &pool.files[f];
+		Reader *reader = &pool.readers[file->thread];
+		for (int l = file->start; l < file->end; l++) {
+			int v = globalID(names, reader, globalOf[file->thread], file->src, urls->len);
+			if (v == DROPPED) break; //as in addLink, a url with no room for it has no edges
+			int w = globalID(names, reader, globalOf[file->thread], reader->links[l], urls->len);
+			if (w == DROPPED) continue;
+			src[nE] = v;
+			dest[nE++] = w;
+		}
+	}
+	SparseGraph graph = newSparseGraph(names, nE, src, dest);
+
+	for (int t = 0; t < nThreads; t++) {
+		disposeHashTable(pool.readers[t].names);
+		free(pool.readers[t].links); free(globalOf[t]);
+	}
+	free(globalOf); free(src); free(dest);
+	free(pool.urls); free(pool.files); free(pool.readers);
+	free(threads); free(workers);
+	return graph;
+}
+
+//Keeps taking the next unread file until there are none left
+static void *readerThread(void *arg) {
+	BuildWorker *worker = arg;
+	BuildPool *pool = worker->pool;
+	while (1) {
+		pthread_mutex_lock(&pool->lock);
+		int f = pool->nextFile++;
+		pthread_mutex_unlock(&pool->lock);
+		if (f >= pool->nFiles) break;
+		readLinks(pool, worker->id, f);
+	}
+	return NULL;
+}
+
+//Reads section 1 of url file f the same way getGraph does, recording its outlinks (other than to itself) in reader id's table
+static void readLinks(BuildPool *pool, int id, int f) {
+	Reader *reader = &pool->readers[id];
+	char *url = pool->urls[f], buffer[MAX_LINE], *link, *rest;
+	char *urlFileName = concat(url, ".txt");
+	FILE *fp = fopen(urlFileName, "r"); assert(fp);
+	free(urlFileName);
+	FileLinks *file = &pool->files[f];
+	file->thread = id;
+	file->src = getID(reader->names, url);
+	file->start = reader->nLinks;
+	while (fgets(buffer, MAX_LINE, fp)) {
+		if (strEQ(buffer, "#start Section-1\n")) continue;
+		if (buffer[0] == '#' && buffer[1] == 'e') break;
+
+		for (link = strtok_r(buffer, " \n", &rest); link; link = strtok_r(NULL, " \n", &rest)) { //strtok keeps its place in a global, so each thread needs strtok_r
+			if (strEQ(url, link)) continue;
+			if (reader->nLinks == reader->maxLinks) {
+				reader->maxLinks *= 2;
+				reader->links = realloc(reader->links, reader->maxLinks*sizeof(int)); assert(reader->links);
+			}
+			reader->links[reader->nLinks++] = getID(reader->names, link);
+		}
+	}
+	file->end = reader->nLinks;
+	fclose(fp);
+}
+
+//The vertex ID of a reader's url, giving it the next one if it doesn't have one yet and there are fewer than maxV vertices
+static int globalID(HashTable names, Reader *reader, int *globalOf, int id, int maxV) {
+	if (globalOf[id] != NOT_FOUND) return globalOf[id];
+	char *url = keyOf(reader->names, id);
+	int v = findID(names, url);
+	if (v == NOT_FOUND) v = nKeys(names) >= maxV ? DROPPED : getID(names, url); //the shared table never shrinks, so a dropped url stays dropped
+	globalOf[id] = v;
+	return v;
+}
@@ -0,0 +1,122 @@
+//Relabels the vertices of the link graph so pages that are linked together get nearby IDs
+//The inner loop reads prevRanks[source] for every in-edge, so the closer the sources of each page are the fewer of those reads miss the cache
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "pagerank.h"
+
+static int *byDegree(SparseGraph);
+static int *breadthFirst(SparseGraph,int);
+static int totalDegree(SparseGraph,int);
+static void sortByDegree(SparseGraph,int[],int);
+
+/*
+Returns newID, where newID[v] is the ID vertex v should have under the given ordering:
+	DegreeOrder: most outlinks first, since those pages' pageranks are read the most
+	BFSOrder: breadth first search over links in either direction, so linked pages end up close together
+	RCMOrder: reverse Cuthill-McKee, breadth first from a low degree page, visiting neighbours lowest degree first, then reversed
+*/
+int *findOrdering(SparseGraph g, VertexOrder order) {
+	if (order == DegreeOrder) return byDegree(g);
+	int *newID = breadthFirst(g, order == RCMOrder);
+	if (order == RCMOrder) {
+		for (int v = 0; v < g->nV; v++) newID[v] = g->nV-1 - newID[v];
+	}
+	return newID;
+}
+
+//Copies the graph with every vertex v renamed newID[v]. The url names move with their vertices
+SparseGraph reorderGraph(SparseGraph g, int newID[]) {
+	int *oldID = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int));
+	int *src = malloc((g->nE > 0 ? g->nE : 1)*sizeof(int)), *dest = malloc((g->nE > 0 ? g->nE : 1)*sizeof(int));
+	assert(oldID && src && dest);
+	for (int v = 0; v < g->nV; v++) oldID[newID[v]] = v;
+	HashTable names = newHashTable(g->nV);
+	for (int v = 0; v < g->nV; v++) getID(names, vertexName(g, oldID[v]));
+	for (int v = 0; v < g->nV; v++) {
+		for (int e = g->outStart[v]; e < g->outStart[v+1]; e++) {
+			src[e] = newID[v];
+			dest[e] = newID[g->outEdges[e]];
+		}
+	}
+	SparseGraph new = newSparseGraph(names, g->nE, src, dest);
+	free(oldID); free(src); free(dest);
+	return new;
+}
+
+//Vertices by number of outlinks, most first, a counting sort so vertices with the same number keep their order
+static int *byDegree(SparseGraph g) {
+	int maxDegree = 0;
+	for (int v = 0; v < g->nV; v++) if (outDegree(g, v) > maxDegree) maxDegree = outDegree(g, v);
+	int *count = calloc(maxDegree+2, sizeof(int)), *newID = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int));
+	assert(count && newID);
+	for (int v = 0; v < g->nV; v++) count[maxDegree - outDegree(g, v) + 1]++;
+	for (int d = 0; d <= maxDegree; d++) count[d+1] += count[d];
+	for (int v = 0; v < g->nV; v++) newID[v] = count[maxDegree - outDegree(g, v)]++;
+	free(count);
+	return newID;
+}
+
+/*
+Numbers the vertices in the order a breadth first search (following links both ways) reaches them.
+Each part of the graph that isn't linked to the rest is searched in turn, starting from its lowest numbered vertex;
+for Cuthill-McKee it starts from the vertex with the fewest links instead and neighbours are visited fewest links first.
+*/
+static int *breadthFirst(SparseGraph g, int cuthillMcKee) {
+	int *newID = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int)), *queue = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int));
+	int *startOrder = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int));
+	assert(newID && queue && startOrder);
+	for (int v = 0; v < g->nV; v++) {
+		newID[v] = -1;
+		startOrder[v] = v;
+	}
+	if (cuthillMcKee) sortByDegree(g, startOrder, g->nV);
+
+	int head = 0, tail = 0;
+	for (int s = 0; s < g->nV; s++) {
+		if (newID[startOrder[s]] != -1) continue;
+		newID[startOrder[s]] = tail;
+		queue[tail++] = startOrder[s];
+		while (head < tail) {
+			int v = queue[head++], first = tail;
+			for (int e = g->outStart[v]; e < g->outStart[v+1]; e++) {
+				if (newID[g->outEdges[e]] == -1) { newID[g->outEdges[e]] = tail; queue[tail++] = g->outEdges[e]; }
+			}
+			for (int e = g->inStart[v]; e < g->inStart[v+1]; e++) {
+				if (newID[g->inEdges[e]] == -1) { newID[g->inEdges[e]] = tail; queue[tail++] = g->inEdges[e]; }
+			}
+			if (cuthillMcKee) {
+				sortByDegree(g, queue+first, tail-first);
+				for (int q = first; q < tail; q++) newID[queue[q]] = q;
+			}
+		}
+	}
+	free(queue); free(startOrder);
+	return newID;
+}
+
+static int totalDegree(SparseGraph g, int v) {
+	return outDegree(g, v) + inDegree(g, v);
+}
+
+//Sorts vertices by how many links they have either way, keeping the order of ties
+static void sortByDegree(SparseGraph g, int vertices[], int n) {
+	if (n > 64) { //a counting sort for the whole graph or a heavily linked page's neighbours, insertion sort for the usual handful
+		int *key = malloc(n*sizeof(int)), *count, maxDegree = 0;
+		for (int i = 0; i < n; i++) if (totalDegree(g, vertices[i]) > maxDegree) maxDegree = totalDegree(g, vertices[i]);
+		count = calloc(maxDegree+2, sizeof(int)); assert(key && count);
+		for (int i = 0; i < n; i++) count[totalDegree(g, vertices[i])+1]++;
+		for (int d = 0; d <= maxDegree; d++) count[d+1] += count[d];
+		for (int i = 0; i < n; i++) key[count[totalDegree(g, vertices[i])]++] = vertices[i];
+		memcpy(vertices, key, n*sizeof(int));
+		free(key); free(count);
+		return;
+	}
+	for (int i = 1; i < n; i++) {
+		int v = vertices[i], j = i;
+		for (; j > 0 && totalDegree(g, vertices[j-1]) > totalDegree(g, v); j--) vertices[j] = vertices[j-1];
+		vertices[j] = v;
+	}
+}
@@ -0,0 +1,176 @@
+//Multi-threaded weighted PageRank iteration
+//Vertices are split into cache-sized blocks that a pool of threads works through, stealing blocks from each other when they run dry
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <pthread.h>
+#include "pagerank.h"
+
+#define BLOCK_EDGES 8192 //in-edges per block, so a block's sources and weights (~160KB) stay in cache while it is worked on
+#define BLOCK_VERTICES 4096 //and a cap on vertices per block for vertices with few in-edges
+
+typedef struct _blockQueue { //blocks still to be done by one thread: the owner takes from the front, thieves from the back
+	pthread_mutex_t lock;
+	int next;
+	int end;
+} BlockQueue;
+
+typedef struct _pool {
+	LinkWeights w;
+	double dampening;
+	int nBlocks;
+	int *blockStart; //block b holds vertices blockStart[b] .. blockStart[b+1]-1
+	double *blockDiff; //each block's share of this iteration's difference
+	double *prevRanks;
+	double *pageRanks;
+	int nThreads;
+	BlockQueue *queues;
+	pthread_barrier_t start;
+	pthread_barrier_t done;
+	int finished;
+} Pool;
+
+typedef struct _worker {
+	Pool *pool;
+	int id;
+} Worker;
+
+static int splitIntoBlocks(LinkWeights,int**);
+static int runIteration(Pool*,int);
+static void doBlock(Pool*,int);
+static int takeBlock(Pool*,int);
+static void *workerThread(void*);
+
+/***********************************************
+split the vertices into blocks
+start nThreads-1 workers; the calling thread is worker 0
+
+for iterations going from 0 to maxIterations while the difference is >= minDiff
+	deal the blocks out evenly between the threads and let them run (stealing as they finish)
+	add up the blocks' differences in block order
+
+Adding the differences up block by block in a fixed order (rather than in whatever order threads finish) means
+the result, and so the number of iterations, is exactly the same for any number of threads
+***********************************************/
+SolverStats iteratePageRankParallel(LinkWeights w, double dampening, double minDiff, int maxIterations, double pageRanks[], int nThreads) {
+	Pool pool = { .w = w, .dampening = dampening, .nThreads = nThreads > 0 ? nThreads : 1, .finished = 0 };
+	pool.nBlocks = splitIntoBlocks(w, &pool.blockStart);
+	pool.blockDiff = calloc(pool.nBlocks > 0 ? pool.nBlocks : 1, sizeof(double));
+	pool.queues = malloc(pool.nThreads*sizeof(BlockQueue));
+	double *spare = malloc((w->nV > 0 ? w->nV : 1)*sizeof(double));
+	pthread_t *threads = malloc(pool.nThreads*sizeof(pthread_t));
+	Worker *workers = malloc(pool.nThreads*sizeof(Worker));
+	assert(pool.blockDiff && pool.queues && spare && threads && workers);
+
+	for (int t = 0; t < pool.nThreads; t++) pthread_mutex_init(&pool.queues[t].lock, NULL);
+	pthread_barrier_init(&pool.start, NULL, pool.nThreads);
+	pthread_barrier_init(&pool.done, NULL, pool.nThreads);
+	for (int t = 1; t < pool.nThreads; t++) {
+		workers[t] = (Worker){ &pool, t };
+		pthread_create(&threads[t], NULL, workerThread, &workers[t]);
+	}
+
+	pool.pageRanks = pageRanks;
+	pool.prevRanks = spare;
+	double diff = minDiff;
+	int iteration = 0;
+	for (; iteration < maxIterations && diff >= minDiff; iteration++) {
+		double *temp = pool.prevRanks; pool.prevRanks = pool.pageRanks; pool.pageRanks = temp; //last iterations pageranks become the previous ones, no copy needed
+		runIteration(&pool, 0);
+		diff = 0;
+		for (int b = 0; b < pool.nBlocks; b++) diff += pool.blockDiff[b];
+	}
+
+	pool.finished = 1;
+	runIteration(&pool, 0); //releases the workers so they can see they're finished
+	for (int t = 1; t < pool.nThreads; t++) pthread_join(threads[t], NULL);
+	if (pool.pageRanks != pageRanks) memcpy(pageRanks, pool.pageRanks, w->nV*sizeof(double));
+
+	for (int t = 0; t < pool.nThreads; t++) pthread_mutex_destroy(&pool.queues[t].lock);
+	pthread_barrier_destroy(&pool.start);
+	pthread_barrier_destroy(&pool.done);
+	free(pool.blockStart); free(pool.blockDiff); free(pool.queues);
+	free(spare); free(threads); free(workers);
+	return (SolverStats){ iteration, (long)iteration*w->nE };
+}
+
+//Cuts the vertices into consecutive blocks of about BLOCK_EDGES in-edges each, so a block with a few heavily linked pages costs about as much as one with many lightly linked ones
+static int splitIntoBlocks(LinkWeights w, int **blockStart) {
+	int nBlocks = 0, maxBlocks = 16;
+	int *start = malloc(maxBlocks*sizeof(int)); assert(start);
+	for (int v = 0; v < w->nV;) {
+		if (nBlocks + 1 == maxBlocks) {
+			maxBlocks *= 2;
+			start = realloc(start, maxBlocks*sizeof(int)); assert(start);
+		}
+		start[nBlocks++] = v;
+		int first = v;
+		while (v < w->nV && v - first < BLOCK_VERTICES && w->inStart[v] - w->inStart[first] < BLOCK_EDGES) v++;
+		if (v == first) v++; //a single vertex with more than BLOCK_EDGES in-edges gets a block to itself
+	}
+	start[nBlocks] = w->nV;
+	*blockStart = start;
+	return nBlocks;
+}
+
+//Deals the blocks out evenly then works through this thread's share until every block is done. Returns 0 once the pool is finished
+static int runIteration(Pool *pool, int id) {
+	if (id == 0) {
+		for (int t = 0; t < pool->nThreads; t++) {
+			pool->queues[t].next = (long)pool->nBlocks*t/pool->nThreads;
+			pool->queues[t].end = (long)pool->nBlocks*(t+1)/pool->nThreads;
+		}
+	}
+	pthread_barrier_wait(&pool->start);
+	if (pool->finished) return 0;
+	for (int b = takeBlock(pool, id); b != -1; b = takeBlock(pool, id)) doBlock(pool, b);
+	pthread_barrier_wait(&pool->done);
+	return 1;
+}
+
+//Calculates this iterations pageranks for the vertices in block b and their difference from the previous ones
+static void doBlock(Pool *pool, int b) {
+	LinkWeights w = pool->w;
+	double base = (double)(1-pool->dampening)/w->nV, diff = 0;
+	for (int i = pool->blockStart[b]; i < pool->blockStart[b+1]; i++) {
+		double total = 0; //the sigma term in the equation
+		for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) total += pool->prevRanks[w->inSrc[e]]*w->wIn[e]*w->wOut[e];
+		pool->pageRanks[i] = base + pool->dampening*total;
+		diff += fabs(pool->pageRanks[i] - pool->prevRanks[i]);
+	}
+	pool->blockDiff[b] = diff;
+}
+
+//Takes the next block from this thread's own queue, or steals the last block of the fullest other queue. -1 when there are none left
+static int takeBlock(Pool *pool, int id) {
+	BlockQueue *own = &pool->queues[id];
+	int b = -1;
+	pthread_mutex_lock(&own->lock);
+	if (own->next < own->end) b = own->next++;
+	pthread_mutex_unlock(&own->lock);
+
+	while (b == -1) {
+		int victim = -1, most = 0;
+		for (int t = 0; t < pool->nThreads; t++) {
+			if (t == id) continue;
+			pthread_mutex_lock(&pool->queues[t].lock); //the owner and other thieves change these under the lock
+			int left = pool->queues[t].end - pool->queues[t].next; //may have changed by the time it is stolen from, so checked again below
+			pthread_mutex_unlock(&pool->queues[t].lock);
+			if (left > most) { most = left; victim = t; }
+		}
+		if (victim == -1) return -1;
+		pthread_mutex_lock(&pool->queues[victim].lock);
+		if (pool->queues[victim].next < pool->queues[victim].end) b = --pool->queues[victim].end;
+		pthread_mutex_unlock(&pool->queues[victim].lock);
+	}
+	return b;
+}
+
+static void *workerThread(void *arg) {
+	Worker *worker = arg;
+	while (runIteration(worker->pool, worker->id));
+	return NULL;
+}
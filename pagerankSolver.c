@@ -0,0 +1,187 @@
+//Weighted PageRank iteration over a precomputed set of link weights
+//Split out of pagerank.c so the weights are worked out once per graph instead of once per vertex per iteration
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "pagerank.h"
+
+/*
+WIn and WOut of an edge p(j) -> p(i) only depend on the link structure, so they are found once here rather than every iteration:
+	WIn  = inlinks to p(i)/(sum of inlinks of the nodes p(j) links to)
+	WOut = outlinks of p(i)/(sum of outlinks of the nodes p(j) links to), where a node with no outlinks counts as 0.5
+The sums are found once per p(j), so this is O(V+E) overall.
+*/
+LinkWeights newLinkWeights(SparseGraph g) {
+	LinkWeights new = malloc(sizeof(struct _linkWeights)); assert(new);
+	double *sumIn = malloc((g->nV > 0 ? g->nV : 1)*sizeof(double)), *sumOut = malloc((g->nV > 0 ? g->nV : 1)*sizeof(double));
+	new->nV = g->nV;
+	new->nE = g->nE;
+	new->inStart = g->inStart;
+	new->inSrc = g->inEdges;
+	new->wIn = malloc((g->nE > 0 ? g->nE : 1)*sizeof(double));
+	new->wOut = malloc((g->nE > 0 ? g->nE : 1)*sizeof(double));
+	new->outStart = g->outStart;
+	new->outDest = g->outEdges;
+	new->outWeight = NULL;
+	assert(sumIn && sumOut && new->wIn && new->wOut);
+
+	for (int j = 0; j < g->nV; j++) {
+		sumIn[j] = getLinksReferencedBy(In, j, g);
+		sumOut[j] = getLinksReferencedBy(Out, j, g);
+	}
+	for (int i = 0; i < g->nV; i++) {
+		double inLinks = getLinks(In, i, g), outLinks = getLinks(Out, i, g);
+		for (int e = g->inStart[i]; e < g->inStart[i+1]; e++) {
+			new->wIn[e] = inLinks/sumIn[g->inEdges[e]];
+			new->wOut[e] = outLinks/sumOut[g->inEdges[e]];
+		}
+	}
+	free(sumIn); free(sumOut);
+	return new;
+}
+
+void freeLinkWeights(LinkWeights w) {
+	free(w->wIn); free(w->wOut); free(w->outWeight);
+	free(w);
+}
+
+//The number of inlinks or outlinks to the node, straight from its degree
+double getLinks(LinkType type, int v, SparseGraph g) {
+	int isInLinks = type == In;
+	int total = isInLinks ? inDegree(g, v) : outDegree(g, v);
+	return isInLinks ? total : (total == 0 ? 0.5 : total); //if it's for inlinks or (outlinks and the total is not 0), return the total, otherwise return 0.5
+}
+
+//Goes through the nodes that the referer links to and sums their inlinks or outlinks
+double getLinksReferencedBy(LinkType type, int referer, SparseGraph g) {
+	double total = 0;
+	for (int e = g->outStart[referer]; e < g->outStart[referer+1]; e++) { //nodes linked to by the current referer of p(i)
+		total += getLinks(type, g->outEdges[e], g); //sum the inlinks or outlinks of the referred nodes
+	}
+	return total;
+}
+
+/***********************************************
+for iterations going from 0 to maxIterations
+	if the difference of the pageranks for this iteration is < the minimumDifference
+		exit
+	otherwise
+		copy over the previous iterations pageranks
+		calculate this iterations pageranks for all urls - one pass over every vertex's in-edges
+		calculate the aggregate difference in pageranks between this iteration and the previous
+
+pageRanks holds the starting pageranks and is left holding the final ones
+returns the number of iterations run and edges processed
+***********************************************/
+SolverStats iteratePageRank(LinkWeights w, double dampening, double minDiff, int maxIterations, double pageRanks[]) {
+	double diff = minDiff;
+	double *prevRanks = calloc(w->nV > 0 ? w->nV : 1, sizeof(double)); assert(prevRanks);
+	int iteration = 0;
+
+	for (; iteration < maxIterations && diff >= minDiff; iteration++) {
+		memcpy(prevRanks, pageRanks, w->nV*sizeof(double)); //copy over the previous iterations pageranks
+		for (int i = 0; i < w->nV; i++) {
+			double total = 0; //the sigma term in the equation
+			for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) total += prevRanks[w->inSrc[e]]*w->wIn[e]*w->wOut[e];
+			pageRanks[i] = (double)(1-dampening)/w->nV + dampening*total; //calculate the pageranks for this iteration
+		}
+		diff = 0;
+		for (int i = 0; i < w->nV; i++) diff += fabs(pageRanks[i] - prevRanks[i]); //find the difference between the new pageranks and the old ones
+	}
+	free(prevRanks);
+	return (SolverStats){ iteration, (long)iteration*w->nE };
+}
+
+/*
+Gauss-Seidel: the same sweep as above, except each new pagerank is written straight back so the vertices after it in the
+sweep already use it. There is no previous iterations array to copy and it settles in noticeably fewer sweeps.
+Stops on the same rule: the pageranks changed by less than minDiff altogether over a sweep.
+*/
+SolverStats iteratePageRankGaussSeidel(LinkWeights w, double dampening, double minDiff, int maxIterations, double pageRanks[]) {
+	double diff = minDiff, base = (double)(1-dampening)/w->nV;
+	int iteration = 0;
+
+	for (; iteration < maxIterations && diff >= minDiff; iteration++) {
+		diff = 0;
+		for (int i = 0; i < w->nV; i++) {
+			double total = 0;
+			for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) total += pageRanks[w->inSrc[e]]*w->wIn[e]*w->wOut[e];
+			double pageRank = base + dampening*total;
+			diff += fabs(pageRank - pageRanks[i]);
+			pageRanks[i] = pageRank;
+		}
+	}
+	return (SolverStats){ iteration, (long)iteration*w->nE };
+}
+
+//Works out WIn*WOut for every out-edge, by walking the in-edges in order and filling each source's out-edges as they come up
+static void findOutWeights(LinkWeights w) {
+	if (w->outWeight) return;
+	w->outWeight = malloc((w->nE > 0 ? w->nE : 1)*sizeof(double));
+	int *fill = malloc((w->nV > 0 ? w->nV : 1)*sizeof(int));
+	assert(w->outWeight && fill);
+	memcpy(fill, w->outStart, w->nV*sizeof(int));
+	for (int i = 0; i < w->nV; i++) {
+		for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) w->outWeight[fill[w->inSrc[e]]++] = w->wIn[e]*w->wOut[e];
+	}
+	free(fill);
+}
+
+/*
+Push: rather than sweeping every vertex, only vertices whose pagerank is still noticeably off do any work.
+The residual of a vertex is how far its pagerank is from what the equation says it should be given everyone else's.
+Pushing a vertex adds its residual to its pagerank and passes dampening*weight of it on to each page it links to,
+so vertices that have settled are never touched again.
+
+A vertex is pushed while its residual is above minDiff/nV, so when nothing is left to push the residuals add up to less than minDiff.
+residual holds each vertex's starting residual for the given pageranks, or is NULL to have it worked out with one full pass.
+Each round pushes every vertex that was over the threshold when the round began.
+*/
+SolverStats iteratePageRankPush(LinkWeights w, double dampening, double minDiff, int maxIterations, double pageRanks[], double residual[]) {
+	SolverStats stats = { 0, 0 };
+	double threshold = minDiff/w->nV, base = (double)(1-dampening)/w->nV;
+	double *r = malloc((w->nV > 0 ? w->nV : 1)*sizeof(double));
+	int *active = malloc((w->nV > 0 ? w->nV : 1)*sizeof(int)), *next = malloc((w->nV > 0 ? w->nV : 1)*sizeof(int));
+	char *queued = calloc(w->nV > 0 ? w->nV : 1, 1);
+	assert(r && active && next && queued);
+	findOutWeights(w);
+
+	if (residual) memcpy(r, residual, w->nV*sizeof(double));
+	else {
+		for (int i = 0; i < w->nV; i++) {
+			double total = 0;
+			for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) total += pageRanks[w->inSrc[e]]*w->wIn[e]*w->wOut[e];
+			r[i] = base + dampening*total - pageRanks[i];
+		}
+		stats.edges += w->nE;
+	}
+	int nActive = 0;
+	for (int i = 0; i < w->nV; i++) {
+		if (fabs(r[i]) > threshold) { active[nActive++] = i; queued[i] = 1; }
+	}
+
+	while (nActive > 0 && stats.iterations < maxIterations) {
+		int nNext = 0;
+		for (int a = 0; a < nActive; a++) {
+			int u = active[a];
+			double push = r[u];
+			queued[u] = 0;
+			r[u] = 0;
+			pageRanks[u] += push;
+			for (int e = w->outStart[u]; e < w->outStart[u+1]; e++) {
+				int v = w->outDest[e];
+				r[v] += dampening*w->outWeight[e]*push;
+				if (!queued[v] && fabs(r[v]) > threshold) { next[nNext++] = v; queued[v] = 1; }
+			}
+			stats.edges += w->outStart[u+1] - w->outStart[u];
+		}
+		int *temp = active; active = next; next = temp;
+		nActive = nNext;
+		stats.iterations++;
+	}
+	free(r); free(active); free(next); free(queued);
+	return stats;
+}
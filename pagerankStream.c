@@ -0,0 +1,184 @@
+//Out-of-core PageRank: the link graph lives in a binary edge file and is streamed from disk every iteration
+//Only the pagerank vectors are kept in memory, so the memory needed is O(V) however many links there are
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "pagerank.h"
+#include "utility.h"
+
+#define EDGE_FILE_MAGIC 0x50524532 //"PRE2"
+#define EDGE_HEADER_SIZE (3*sizeof(int) + sizeof(unsigned long long))
+#define BLOCK_RECORDS 65536 //edges read per block (1.5MB), large enough that reading is sequential and limited by the disk
+
+typedef struct _edgeRecord { //an edge p(j) -> p(i) with its weights, exactly as iteratePageRank uses them
+	int src;
+	int dest;
+	double wIn;
+	double wOut;
+} EdgeRecord;
+
+static unsigned long long stampFile(unsigned long long,char*);
+static void cutShort();
+
+/*
+The size and modification time of collection.txt and of every url file it lists, hashed together.
+An edge file records this for the files it was built from, so one built before any of them changed isn't reused
+*/
+unsigned long long sourceStamp() {
+	unsigned long long stamp = stampFile(14695981039346656037ULL, "collection.txt"); //the FNV-1a offset basis
+	URLQueue urls = getURLS();
+	for (URLNode curr = urls->head; curr; curr = curr->next) {
+		char *urlFileName = concat(curr->URL, ".txt");
+		stamp = stampFile(stamp, urlFileName);
+		free(urlFileName);
+	}
+	freeURLQueue(urls);
+	return stamp;
+}
+
+//Hashes a file's name, size and modification time into stamp with FNV-1a
+static unsigned long long stampFile(unsigned long long stamp, char *fileName) {
+	struct stat st;
+	long long fields[2] = { -1, -1 }; //for a file that isn't there
+	if (stat(fileName, &st) == 0) {
+		fields[0] = st.st_size;
+		fields[1] = st.st_mtim.tv_sec*1000000000LL + st.st_mtim.tv_nsec;
+	}
+	unsigned char *bytes = (unsigned char *)fields;
+	for (size_t b = 0; b < sizeof(fields); b++) stamp = (stamp ^ bytes[b])*1099511628211ULL;
+	for (char *c = fileName; *c; c++) stamp = (stamp ^ (unsigned char)*c)*1099511628211ULL;
+	return stamp;
+}
+
+/*
+Edge file layout:
+	magic, nV, nE (ints), then the sourceStamp of the files the links came from
+	nE EdgeRecords in the order iteratePageRank visits them: by destination, then by increasing source
+	the vertex table: for every vertex in ID order, its number of outlinks, the length of its name and the name itself
+*/
+void writeEdgeFile(SparseGraph g, LinkWeights w, char *edgeFileName, unsigned long long stamp) {
+	char *tmpName = concat(edgeFileName, ".tmp"); //renamed into place once it's all written, so a run cut off part way leaves no edge file behind
+	FILE *fp = fopen(tmpName, "wb");
+	if (!fp) {
+		perror(tmpName);
+		exit(1);
+	}
+	int header[3] = { EDGE_FILE_MAGIC, g->nV, g->nE };
+	fwrite(header, sizeof(int), 3, fp);
+	fwrite(&stamp, sizeof(stamp), 1, fp);
+	EdgeRecord *block = malloc(BLOCK_RECORDS*sizeof(EdgeRecord)); assert(block);
+	int n = 0;
+	for (int i = 0; i < g->nV; i++) {
+		for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) {
+			block[n++] = (EdgeRecord){ w->inSrc[e], i, w->wIn[e], w->wOut[e] };
+			if (n == BLOCK_RECORDS) { fwrite(block, sizeof(EdgeRecord), n, fp); n = 0; }
+		}
+	}
+	fwrite(block, sizeof(EdgeRecord), n, fp);
+	free(block);
+	for (int v = 0; v < g->nV; v++) {
+		int entry[2] = { outDegree(g, v), strlen(vertexName(g, v)) };
+		fwrite(entry, sizeof(int), 2, fp);
+		fwrite(vertexName(g, v), 1, entry[1], fp);
+	}
+	if (ferror(fp) | fclose(fp) || rename(tmpName, edgeFileName) != 0) {
+		perror(edgeFileName);
+		unlink(tmpName);
+		exit(1);
+	}
+	free(tmpName);
+}
+
+//Opens an edge file written by writeEdgeFile from the files with sourceStamp stamp, or returns NULL if there isn't a valid one
+EdgeFile openEdgeFile(char *edgeFileName, unsigned long long stamp) {
+	FILE *fp = fopen(edgeFileName, "rb");
+	if (!fp) return NULL;
+	int header[3];
+	unsigned long long builtFrom;
+	struct stat st;
+	if (fread(header, sizeof(int), 3, fp) != 3 || header[0] != EDGE_FILE_MAGIC || header[1] < 0 || header[2] < 0 || fread(&builtFrom, sizeof(builtFrom), 1, fp) != 1
+	    || fstat(fileno(fp), &st) != 0 || st.st_size < (off_t)(EDGE_HEADER_SIZE + (size_t)header[2]*sizeof(EdgeRecord))) {
+		fprintf(stderr, "%s is not a usable edge file, rebuilding it\n", edgeFileName);
+		fclose(fp);
+		return NULL;
+	}
+	if (builtFrom != stamp) {
+		fprintf(stderr, "%s is out of date with the url files, rebuilding it\n", edgeFileName);
+		fclose(fp);
+		return NULL;
+	}
+	posix_fadvise(fileno(fp), 0, 0, POSIX_FADV_SEQUENTIAL); //read ahead aggressively, each iteration goes through the file front to back
+	EdgeFile new = malloc(sizeof(struct _edgeFile)); assert(new);
+	new->fp = fp;
+	new->nV = header[1];
+	new->nE = header[2];
+	return new;
+}
+
+void closeEdgeFile(EdgeFile ef) {
+	fclose(ef->fp);
+	free(ef);
+}
+
+/***********************************************
+for iterations going from 0 to maxIterations while the difference is >= minDiff
+	the previous iterations pageranks are the ones just calculated
+	read the edges from disk a block at a time, adding prev pagerank of p(j) * WIn * WOut into the sigma term of p(i)
+	turn each sigma term into this iterations pagerank and find the difference from the previous one
+
+The file is read through stdio rather than mapped, so pages of it never count towards this process's memory.
+The edges come in the same order iteratePageRank goes through them, so the pageranks come out exactly the same.
+***********************************************/
+SolverStats iteratePageRankStream(EdgeFile ef, double dampening, double minDiff, int maxIterations, double pageRanks[]) {
+	double diff = minDiff, base = (double)(1-dampening)/ef->nV;
+	double *prevRanks = malloc((ef->nV > 0 ? ef->nV : 1)*sizeof(double));
+	EdgeRecord *block = malloc(BLOCK_RECORDS*sizeof(EdgeRecord));
+	assert(prevRanks && block);
+	int iteration = 0;
+
+	for (; iteration < maxIterations && diff >= minDiff; iteration++) {
+		memcpy(prevRanks, pageRanks, ef->nV*sizeof(double));
+		memset(pageRanks, 0, ef->nV*sizeof(double)); //each pagerank holds its sigma term until the edges have all been read
+		fseek(ef->fp, EDGE_HEADER_SIZE, SEEK_SET);
+		for (long read = 0; read < ef->nE;) {
+			int n = ef->nE - read < BLOCK_RECORDS ? ef->nE - read : BLOCK_RECORDS;
+			if (fread(block, sizeof(EdgeRecord), n, ef->fp) != (size_t)n) cutShort();
+			for (int e = 0; e < n; e++) pageRanks[block[e].dest] += prevRanks[block[e].src]*block[e].wIn*block[e].wOut;
+			read += n;
+		}
+		diff = 0;
+		for (int i = 0; i < ef->nV; i++) {
+			pageRanks[i] = base + dampening*pageRanks[i];
+			diff += fabs(pageRanks[i] - prevRanks[i]);
+		}
+	}
+	free(prevRanks); free(block);
+	return (SolverStats){ iteration, (long)iteration*ef->nE };
+}
+
+//Reads the vertex table at the end of the edge file: returns the url -> vertex ID table and fills in each vertex's number of outlinks
+HashTable readVertexTable(EdgeFile ef, int outLinks[]) {
+	HashTable names = newHashTable(ef->nV);
+	fseek(ef->fp, EDGE_HEADER_SIZE + (long)ef->nE*sizeof(EdgeRecord), SEEK_SET);
+	char name[MAX_LINE];
+	for (int v = 0; v < ef->nV; v++) {
+		int entry[2];
+		if (fread(entry, sizeof(int), 2, ef->fp) != 2 || entry[1] < 0 || entry[1] >= MAX_LINE || fread(name, 1, entry[1], ef->fp) != (size_t)entry[1]) cutShort();
+		name[entry[1]] = '\0';
+		outLinks[v] = entry[0];
+		getID(names, name);
+	}
+	return names;
+}
+
+//Stops on an edge file that ends (or can't be read) before all it says it holds, e.g. one truncated since it was opened
+static void cutShort() {
+	fprintf(stderr, "The edge file is cut short or could not be read, delete it to have it rebuilt\n");
+	exit(1);
+}
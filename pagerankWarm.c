@@ -0,0 +1,131 @@
+//Warm-starting PageRank from the last run, so a small change to the crawl only costs work around the pages that changed
+//The last run's graph and pageranks are kept in a binary snapshot next to pagerankList.txt
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <unistd.h>
+#include "pagerank.h"
+#include "URL.h"
+#include "utility.h"
+
+#define SNAPSHOT_MAGIC 0x50525331 //"PRS1"
+
+static void loadPageRankList(SparseGraph,double[]);
+static int inEdgesChanged(SparseGraph,LinkWeights,int,SparseGraph,LinkWeights,int,int[],int[]);
+
+/*
+Writes the graph, dampening and full precision pageranks for the next run to warm start from.
+They go to a temporary file that is renamed over the snapshot once it is all written, so a run that dies part way
+(or a full disk) leaves the last good snapshot in place rather than one the next run would have to start cold from
+*/
+void saveSnapshot(SparseGraph g, double dampening, double pageRanks[], char *snapshotFile) {
+	char *tmpName = concat(snapshotFile, ".tmp");
+	FILE *fp = fopen(tmpName, "wb");
+	if (!fp) {
+		perror(tmpName);
+		exit(1);
+	}
+	int magic = SNAPSHOT_MAGIC;
+	int failed = !(fwrite(&magic, sizeof(int), 1, fp) == 1 && fwrite(&dampening, sizeof(double), 1, fp) == 1 && saveSparseGraph(g, fp)
+	             && fwrite(pageRanks, sizeof(double), g->nV, fp) == (size_t)g->nV);
+	if (failed | fclose(fp) || rename(tmpName, snapshotFile) != 0) {
+		fprintf(stderr, "Could not write the snapshot %s, the last one is left as it was\n", snapshotFile);
+		unlink(tmpName);
+		exit(1);
+	}
+	free(tmpName);
+}
+
+/*
+Fills in starting pageranks and residuals for the push solver from the last run's snapshot.
+
+Every page keeps its old pagerank (new pages start at 1/nV). The old graph is then compared to the new one page by page:
+a page's equation only changes if it gained or lost an inlink, or the weight of one of its inlinks changed
+(which covers pages whose linkers changed what else they link to). Only those pages get their residual worked out in full.
+Every other page was already settled under the same equation, so its residual is just the change in the (1-d)/nV term.
+The comparison is one linear pass over the edges; iterating from here only costs work proportional to what changed.
+
+Returns the number of pages whose equation changed, or NOT_FOUND if there is no usable snapshot. In that case the
+starting pageranks come from pagerankList.txt where possible and residual is left for the solver to work out.
+*/
+int warmStart(SparseGraph g, LinkWeights w, double dampening, char *snapshotFile, double pageRanks[], double residual[]) {
+	for (int i = 0; i < g->nV; i++) pageRanks[i] = (double)1/g->nV;
+
+	FILE *fp = fopen(snapshotFile, "rb");
+	int magic = 0; double oldDampening = 0;
+	SparseGraph old = NULL;
+	if (fp && fread(&magic, sizeof(int), 1, fp) == 1 && magic == SNAPSHOT_MAGIC && fread(&oldDampening, sizeof(double), 1, fp) == 1) old = loadSparseGraph(fp);
+	double *oldRanks = old ? malloc((old->nV > 0 ? old->nV : 1)*sizeof(double)) : NULL;
+	if (old && fread(oldRanks, sizeof(double), old->nV, fp) != (size_t)old->nV) {
+		disposeSparseGraph(old); old = NULL;
+	}
+	if (fp) fclose(fp);
+	if (!old) {
+		free(oldRanks);
+		loadPageRankList(g, pageRanks);
+		return NOT_FOUND;
+	}
+
+	int *oldID = malloc((g->nV > 0 ? g->nV : 1)*sizeof(int)), *seenAt = malloc((old->nV > 0 ? old->nV : 1)*sizeof(int));
+	assert(oldID && seenAt);
+	for (int i = 0; i < g->nV; i++) {
+		oldID[i] = findID(old->names, vertexName(g, i));
+		if (oldID[i] != NOT_FOUND) pageRanks[i] = oldRanks[oldID[i]];
+	}
+	for (int v = 0; v < old->nV; v++) seenAt[v] = -1;
+
+	int changed = oldDampening == dampening ? 0 : NOT_FOUND; //a different dampening changes every equation, so start from scratch
+	if (changed == 0) {
+		LinkWeights oldWeights = newLinkWeights(old);
+		double base = (double)(1-dampening)/g->nV, oldBase = (double)(1-dampening)/old->nV;
+		for (int i = 0; i < g->nV; i++) {
+			if (oldID[i] != NOT_FOUND && !inEdgesChanged(g, w, i, old, oldWeights, oldID[i], oldID, seenAt)) {
+				residual[i] = base - oldBase;
+				continue;
+			}
+			double total = 0;
+			for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) total += pageRanks[w->inSrc[e]]*w->wIn[e]*w->wOut[e];
+			residual[i] = base + dampening*total - pageRanks[i];
+			changed++;
+		}
+		freeLinkWeights(oldWeights);
+	}
+
+	free(oldID); free(seenAt); free(oldRanks);
+	disposeSparseGraph(old);
+	return changed;
+}
+
+/*
+Compares page i's inlinks in the new graph with the same page's (oi) in the old one, matching linkers by name.
+seenAt[j] records where old linker j sits in the old edge arrays; it is only trusted if that spot lies in oi's row and holds j,
+so it never needs clearing between pages.
+*/
+static int inEdgesChanged(SparseGraph g, LinkWeights w, int i, SparseGraph old, LinkWeights oldWeights, int oi, int oldID[], int seenAt[]) {
+	if (inDegree(g, i) != inDegree(old, oi)) return 1;
+	for (int e = oldWeights->inStart[oi]; e < oldWeights->inStart[oi+1]; e++) seenAt[oldWeights->inSrc[e]] = e;
+	for (int e = w->inStart[i]; e < w->inStart[i+1]; e++) {
+		int oj = oldID[w->inSrc[e]];
+		if (oj == NOT_FOUND) return 1;
+		int oe = seenAt[oj];
+		if (oe < oldWeights->inStart[oi] || oe >= oldWeights->inStart[oi+1] || oldWeights->inSrc[oe] != oj) return 1;
+		if (oldWeights->wIn[oe] != w->wIn[e] || oldWeights->wOut[oe] != w->wOut[e]) return 1;
+	}
+	return 0;
+}
+
+//Without a snapshot, starts each page from the pagerank in the last pagerankList.txt (if there is one)
+static void loadPageRankList(SparseGraph g, double pageRanks[]) {
+	char buffer[MAX_LINE], url[MAX_LINE]; double pageRank = 0;
+	FILE *fp = fopen("pagerankList.txt", "r");
+	if (!fp) return;
+	while (fgets(buffer, MAX_LINE, fp)) {
+		if (sscanf(buffer, "%[^,], %*d, %lf", url, &pageRank) != 2) continue;
+		int v = findID(g->names, url);
+		if (v != NOT_FOUND) pageRanks[v] = pageRank;
+	}
+	fclose(fp);
+}
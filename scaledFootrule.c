@@ -26,7 +26,8 @@ Therefore the minimum SFD position form URL1 is anywhere between (and including)
 Any movement between 3 and 6 will mean moving further away from 2 ranks and closer to 2 ranks in equal measure, maintaining a constant total distance. Once it is beyond the bounds (3 and 6)
 it will be moving further away from 3 ranks and closer to 1 rank, therefore increasing SFD.
 
-If every URL can be placed using this approach then a guaranteed min SFD is found in 'n' time and the program will return this.  However in most cases eventually a URL will have its range of min SFD positions (range = 1 for URLs with an odd number of ranks) filled by previously placed URLs.
+If every URL can be placed using this approach then the arrangement is close to min SFD, though not guaranteed to be it: positions are whole
+numbers, and the one nearest a URL's middlemost rank isn't always the best once its neighbours are placed. However in most cases eventually a URL will have its range of min SFD positions (range = 1 for URLs with an odd number of ranks) filled by previously placed URLs.
 To combat this when a node wants to be placed in a position which has already been filled, the new URL and the current tenant are compared as to minimise SFD if one was to move one spot to the left. 
 Whichever URL would be best to keep in the current spot is stored in a temporary ranklist while the other URL is used as the new URL to repeat the process on the position 1 to the left. This continues iteratively
 until a free position is found.
@@ -35,51 +36,44 @@ This process is then repeated but with comparisons one to the right rather than
 SFD increase is implemented on the actual ranklist. 
 
 While this secondary approach does not guarantee absolute minimum SFD it is correct in many simple cases (small datasets or when the preferred rank of all URLs is nicely spread) and for all cases it gives axtremely good 'bar' case
-(on average within 1% of min SFD) for the factorial step. In this way any arrangement of URLs can be discredited as a min SFD arrangement as soon as its total SFD exceeds that of the 'bar' arrangement, saving us for completeing unnecessary SFD calculations,
-for this suboptimal case.
+(on average within 1% of min SFD).
 
-In conclusion, while this is still a O(n!) algorithm it beats the brute force approach in 2 major ways:
-1) In simple cases (where all URLs can be placed at a rank/position within their optimal range) it finishes in 'n' time complexity.
-2) By using the above method to find a 'bar' rankset and SFD approximating the min SFD, in the factorial step in calculating a ranksets total SFD, as soon as that ranksets SFD exceeds that of the 'bar', 
-that rankset can be excluded immediately and all SFD calculations on that rankset are avoided.
-*/
+In conclusion this approach is used as a fast approximate mode (-a) which gives a rankset within ~1% of min SFD without any further work.
 
-int main(int argc, char *argv[]) {
-    char buffer[MAX_LINE] = {0};
-    int URLsInFile = 0;
-    int URLRank = 0;
-    SFDURLList uList = newSFDURLList();                                                	//url linked list used to store all urls ranked in rankfiles.
+Otherwise the exact min SFD is found by treating the problem as an assignment of URLs to positions,
+where the cost of assigning a URL to a position is its SFD at that position (calculateSFD). This is solved with the Hungarian method in O(n^3)
+rather than checking every permutation of the ranklist in O(n!).
 
-    for (int i = 1; i < argc; i++) {
-        FILE *fp = fopen(argv[i], "r");
+When only the best few URLs are wanted (-k) none of the above is needed: medianTopK reads the rankfiles in lockstep and
+stops as soon as the top k URLs by median rank are settled, so only a prefix of each rankfile is ever read.
+*/
 
-        while (fgets(buffer, MAX_LINE, fp)) URLsInFile++;                           //total number of URLs in a given rankfile are counted so that ranks can be written as the appropriate fraction for SFD calculation.
-        rewind(fp);                                                                //time complexity = total number of ranks across all rankfiles = O(R)
-        while (fgets(buffer, MAX_LINE, fp)) {                                       //now urls are actually added to the list with their ranks (or rank added to a URL node if the URL read already has a node)
-            URLRank++;                                                             //time complexity = total number of ranks across all rankfiles = O(R)
-            char *token = strtok(buffer, " \n");
-            uList->head = newSFDURLNode(uList, token, URLsInFile, URLRank);
-        }
-        URLsInFile = 0;
-        URLRank = 0;
+int main(int argc, char *argv[]) {
+    int approximate = FALSE, topK = 0, first = 1;
+    for (; first < argc && argv[first][0] == '-'; first++) {
+        if (strcmp(argv[first], "-a") == 0) approximate = TRUE;                      //-a skips the exact solver and settles for the bar case
+        else if (strcmp(argv[first], "-k") == 0 && first + 1 < argc) topK = atoi(argv[++first]); //-k only finds the top k URLs by median rank
+        else break;
+    }
+    if (first == argc || argv[first][0] == '-') {                                          //no rankfiles or an unknown option
+        fprintf(stderr, "Usage: [-a | -k <topK>] <rankFile> <rankFile> ...\n");
+        return 1;
+    }
+    if (topK > 0) {
+        medianTopK(argc - first, argv + first, topK);
+        return 0;
     }
+    SFDURLList uList = loadRankFiles(argc - first, argv + first);                      //every URL ranked in the rankfiles along with its ranks. O(R)
 
-    SFDURLNode *bestRanks = malloc((uList->length + 1) * sizeof(SFDURLNode));
+    SFDURLNode *bestRanks = calloc(uList->length + 1, sizeof(SFDURLNode));
     assert(bestRanks);
 
-    int barIsOptimal = barRanking(bestRanks, uList);                                           				//integrated ranklist found
     double totalSFD = 0;
- 
-    for (int i = 1; i < uList->length + 1; i++) totalSFD += calculateSFD(bestRanks[i], i, uList->length);	//final SFDs added to find totalSFD
-    																										//time complexity = total number of URLs ranked = O(U)   
-    if (barIsOptimal == FALSE) {																			//If left and right search were never applied then bestRanks at its current state is guaranteed to be a min SFD arrangement (from postulates at the top of the page).
-        SFDURLNode *workingRanks = malloc((uList->length + 1) * sizeof(SFDURLNode));
-        assert(workingRanks);
-
-	    for (int i = 1; i < uList->length + 1; i++) workingRanks[i] = bestRanks[i];  			//workingRanks set up to be permuted in factorial checking step. //time complexity = O(U)
-	    checkMinimum(bestRanks, workingRanks, &totalSFD, 1, uList->length);             //factorial checking step
-        free(workingRanks);			                                     
-	}
+    if (!approximate) totalSFD = exactRanking(bestRanks, uList);                                  //solve the assignment problem exactly. O(n^3)
+    else {
+        barRanking(bestRanks, uList);                                                          //integrated ranklist found
+        for (int i = 1; i < uList->length + 1; i++) totalSFD += calculateSFD(bestRanks[i], i, uList->length);	//final SFDs added to find totalSFD
+    }    																									//time complexity = total number of URLs ranked = O(U)
 
     printf("minSFD = %.6f\n" , totalSFD);
     for (int i = 0; i < uList->length + 1; i++) {                               		//time complexity = total number of URLs ranked = O(U)
@@ -93,45 +87,37 @@ int main(int argc, char *argv[]) {
 
 
 //Actual integreated ranking algorithm for the bar case.
-int barRanking(SFDURLNode bestRanks[], SFDURLList uList) {
-	int guaranteedMinSFD = TRUE;
-    SFDURLNode *leftChanges = malloc(uList->length * sizeof(SFDURLNode));
+void barRanking(SFDURLNode bestRanks[], SFDURLList uList) {
+    SFDURLNode *leftChanges = malloc((uList->length + 1) * sizeof(SFDURLNode));       //positions run from 1 to length inclusive
     assert(leftChanges);
 
-    SFDURLNode *rightChanges = malloc(uList->length * sizeof(SFDURLNode));
+    SFDURLNode *rightChanges = malloc((uList->length + 1) * sizeof(SFDURLNode));
     assert(rightChanges);
 
     int chosenRank[2] = {0};
     for (SFDURLNode curr = uList->head; curr; curr = curr->next) {          			//URLs with an odd number of ranks are found positions first as they only have one min SFD position while those with an even number of
                                                                                     		//ranks can have many, thereby minimizing the number of time URLs already placed in final_ranking will need to be changed
-        if (curr->ranks->length % 2 == 1) {
-            RankNode middleRank = curr->ranks->head;
-            for (int i = 1; i != (curr->ranks->length/2 + 1); i++) {
-                middleRank = middleRank->next;
-            }
-            chosenRank[0] = fabs(middleRank->rank_no * uList->length);           			//rank scaled to length of final ranklist and rounded to an integer value to represent a position in this list
+        if (curr->nRanks % 2 == 1) {
+            double middleRank = curr->ranks[curr->nRanks/2];
+            chosenRank[0] = fabs(middleRank * uList->length);                			//rank scaled to length of final ranklist and rounded to an integer value to represent a position in this list
             if (!bestRanks[chosenRank[0]]) {                               			//if this optimal position for the URL in the final ranklist is empty, place the URL at that position.
                 bestRanks[chosenRank[0]] = curr;
             } 
             else {
                 FindSFDRank(bestRanks, uList, curr, chosenRank, leftChanges, rightChanges); //if not we may need to move URLs from their optimal position.
-               	guaranteedMinSFD = FALSE;													//FIndSFDRank removes the guarantee that bestRanks is a min SFD arrangement therefore the factorial checking method will be necessary.
                 chosenRank[1] = 0;
             }
         }
     }
     for (SFDURLNode curr = uList->head; curr; curr = curr->next) {           			//Now attempt to position URls with an even number of ranks.
-        if (curr->ranks->length % 2 == 0) {
-            RankNode L_middleRank = curr->ranks->head;
-            for (int i = 1; i != (curr->ranks->length/2); i++) {
-                L_middleRank = L_middleRank->next;
-            }
-           	RankNode R_middleRank = L_middleRank->next;                             		//L & R_middleRank are the Left and Right boundaries of the min SFD range
-            if (L_middleRank->rank_no * uList->length == (int)(L_middleRank->rank_no * uList->length)) 
-                chosenRank[0] = L_middleRank->rank_no * uList->length; 						//takes the ceiling
-            else chosenRank[0] = (int)(L_middleRank->rank_no* uList->length) + 1;
-
-            chosenRank[1] = (int)(R_middleRank->rank_no * uList->length); 					//takes the floor, this is to ensure the range only contains min SFD ranks 
+        if (curr->nRanks % 2 == 0) {
+            double L_middleRank = curr->ranks[curr->nRanks/2 - 1];
+           	double R_middleRank = curr->ranks[curr->nRanks/2];                             		//L & R_middleRank are the Left and Right boundaries of the min SFD range
+            if (L_middleRank * uList->length == (int)(L_middleRank * uList->length)) 
+                chosenRank[0] = L_middleRank * uList->length; 								//takes the ceiling
+            else chosenRank[0] = (int)(L_middleRank * uList->length) + 1;
+
+            chosenRank[1] = (int)(R_middleRank * uList->length); 					//takes the floor, this is to ensure the range only contains min SFD ranks 
             																				//e.g. if a URL had 2 ranks (scaled to final list length) 4.1 and 8.9, its min SFD range is positions 5 to 8.
             int positionFound = FALSE;
             for (int i = chosenRank[0]; i <= chosenRank[1]; i++) {							//searches min SFD range for the URL, inserts node if possible.
@@ -143,13 +129,11 @@ int barRanking(SFDURLNode bestRanks[], SFDURLList uList) {
             }
             if (positionFound == FALSE) {
             	FindSFDRank(bestRanks, uList, curr, chosenRank, leftChanges, rightChanges);	//if not we may need to move URLs from their optimal position.
-            	guaranteedMinSFD = FALSE;													//FIndSFDRank removes the guarantee that bestRanks is a min SFD arrangement therefore the factorial checking method will be necessary.
             }																						
         }
     }
     free(leftChanges);
     free(rightChanges);
-    return guaranteedMinSFD;
 }
 
 
@@ -242,49 +226,150 @@ int searchRight(SFDURLNode ranks[], int listLength, SFDURLNode currNode, int cho
 
 
 //Uses the scaled footrule algorithm to determine a URLs SFD score at any given position/rank.
+//Ranks below the position contribute (position - rank) and ranks above it contribute (rank - position), so with the ranks sorted
+//and their prefix sums precomputed the total only needs a binary search for where the position falls. O(log r) rather than O(r)
 double calculateSFD(SFDURLNode node, int givenRank, int totalURLs) {
-    double SFD = 0;
-    for (RankNode rank = node->ranks->head; rank != NULL; rank = rank->next) {
-        SFD += fabs(rank->rank_no - (double)givenRank/totalURLs);
+    double position = (double)givenRank/totalURLs;
+    int lo = 0, hi = node->nRanks;
+    while (lo < hi) {                                                           //lo = number of ranks below position
+        int mid = (lo + hi) / 2;
+        if (node->ranks[mid] < position) lo = mid + 1;
+        else hi = mid;
     }
-    return SFD;
+    double below = position * lo - node->rankSums[lo];
+    double above = (node->rankSums[node->nRanks] - node->rankSums[lo]) - position * (node->nRanks - lo);
+    return below + above;
 }
 
 
-//Finds every permutation of the ranklist so it can be checked for minSFD value. O(n!)
-//Based off code to print out every permutation of a string found at http://www.geeksforgeeks.org/write-a-c-program-to-print-all-permutations-of-a-given-string/
-//but naturally heavily modified to fit this case
-void checkMinimum(SFDURLNode *bestRanks, SFDURLNode *workingRanks, double *barSFD, int mover, int listLength) {
-    if (mover == listLength) checkSFD(bestRanks, workingRanks, listLength, barSFD);	//when a new permutation is found check its SFD
-    else {
-        for (int i = mover; i <= listLength; i++) {
-            swap(workingRanks, mover, i);
-            checkMinimum(bestRanks, workingRanks, barSFD, mover + 1, listLength);
-            swap(workingRanks, mover, i);       
+//Finds a min SFD rankset exactly by treating it as an assignment of URLs (rows) to positions (columns), where assigning a URL to a position costs its SFD there.
+//Solved with the Hungarian method: each URL is added in turn and placed along the cheapest augmenting path under the current potentials u and v,
+//so the costs are only ever asked for with calculateSFD and never stored as an n*n matrix. O(n^3) rather than O(n!)
+double exactRanking(SFDURLNode bestRanks[], SFDURLList uList) {
+    int n = uList->length;
+    SFDURLNode *rows = malloc((n + 1) * sizeof(SFDURLNode));
+    double *u = calloc(n + 1, sizeof(double));                                  //potential of each URL
+    double *v = calloc(n + 1, sizeof(double));                                  //potential of each position
+    double *minv = malloc((n + 1) * sizeof(double));                            //smallest reduced cost reaching each position in the current search
+    int *owner = calloc(n + 1, sizeof(int));                                    //URL currently assigned to each position (0 = free)
+    int *way = calloc(n + 1, sizeof(int));                                      //previous position on the augmenting path
+    char *used = malloc(n + 1);
+    assert(rows && u && v && minv && owner && way && used);
+
+    int row = 1;
+    for (SFDURLNode curr = uList->head; curr; curr = curr->next) rows[row++] = curr;
+
+    for (int i = 1; i <= n; i++) {
+        owner[0] = i;
+        int pos = 0;
+        for (int j = 0; j <= n; j++) {
+            minv[j] = INFINITY;
+            used[j] = FALSE;
         }
+        do {                                                                    //grow the search tree one position at a time until a free position is reached
+            used[pos] = TRUE;
+            int curr = owner[pos], next = 0;
+            double delta = INFINITY;
+            for (int j = 1; j <= n; j++) {
+                if (used[j]) continue;
+                double reduced = calculateSFD(rows[curr], j, n) - u[curr] - v[j];
+                if (reduced < minv[j]) {
+                    minv[j] = reduced;
+                    way[j] = pos;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    next = j;
+                }
+            }
+            for (int j = 0; j <= n; j++) {
+                if (used[j]) {
+                    u[owner[j]] += delta;
+                    v[j] -= delta;
+                }
+                else minv[j] -= delta;
+            }
+            pos = next;
+        } while (owner[pos] != 0);
+        do {                                                                    //shift every URL on the augmenting path along by one position
+            int prev = way[pos];
+            owner[pos] = owner[prev];
+            pos = prev;
+        } while (pos);
     }
-}
 
+    double totalSFD = 0;
+    bestRanks[0] = NULL;
+    for (int j = 1; j <= n; j++) {
+        bestRanks[j] = rows[owner[j]];
+        totalSFD += calculateSFD(bestRanks[j], j, n);
+    }
 
-//Swaps positions (i.e. ranks) of 2 URLs
-void swap(SFDURLNode *list, int x, int y) {
-    SFDURLNode temp = NULL;
-    temp = list[x];
-    list[x] = list[y];
-    list[y] = temp;
+    free(rows); free(u); free(v); free(minv); free(owner); free(way); free(used);
+    return totalSFD;
 }
 
 
-//Calculates the total SFD of a rankset. As soon as this SFD calculation exceeds that of the barSFD (current best SFD found) the calculations stop.
-//By finding an extremely accurate barSFD from the previous functions this will mean almost all SFD calculations will return early, skipping many unnecessary calculations.
-void checkSFD(SFDURLNode *bestRanks, SFDURLNode *workingRanks, int listLength, double *barSFD) {    
-    double totalSFD = 0;
-    for (int i = 1; i < listLength + 1; i++) {							//O(n) adding SFDs of each URL 
-        totalSFD += calculateSFD(workingRanks[i], i, listLength);
-        if (totalSFD >= *barSFD) return;
+/*
+Fagin's MEDRANK: reads one line from every rankfile per step (depth), counting how many rankfiles each URL has been seen in.
+A URL's median rank is the depth at which it has been seen in more than half of the rankfiles, and no URL still unseen by then can
+have a smaller median, so URLs are settled (and can be output) in that order. Reading stops once k URLs are settled.
+
+Ranks are compared by depth rather than scaled by file length, as a rankfile's length is only known once it has been read in full.
+For rankfiles of equal length (e.g. each a top-N result list) this is the same as the median scaled rank.
+If every rankfile runs out first, the remaining URLs never reach a median and follow in order of how many rankfiles they were in.
+*/
+void medianTopK(int nFiles, char *fileNames[], int k) {
+    char buffer[MAX_LINE] = {0};
+    int needed = nFiles/2 + 1;                                                      //rankfiles a URL must be seen in for its median to be known
+    int nSettled = 0, openFiles = nFiles, depth = 0;
+    int *settled = malloc(k * sizeof(int));
+    int *depthRead = calloc(nFiles, sizeof(int));
+    FILE **fps = malloc(nFiles * sizeof(FILE *));
+    HashTable URLs = newHashTable(k * nFiles);
+    int maxURLs = k * nFiles + 1, *seenIn = calloc(maxURLs, sizeof(int));
+    assert(settled && depthRead && fps && seenIn);
+
+    for (int i = 0; i < nFiles; i++) {
+        fps[i] = fopen(fileNames[i], "r"); assert(fps[i]);
+    }
+    while (nSettled < k && openFiles > 0) {                                         //time complexity = depth reached * number of rankfiles
+        depth++;
+        for (int i = 0; i < nFiles && nSettled < k; i++) {
+            if (!fps[i]) continue;
+            if (!fgets(buffer, MAX_LINE, fps[i])) {
+                fclose(fps[i]);
+                fps[i] = NULL;
+                openFiles--;
+                continue;
+            }
+            depthRead[i] = depth;
+            char *token = strtok(buffer, " \n");
+            if (!token) continue;
+            int id = getID(URLs, token);
+            if (id == maxURLs) {
+                seenIn = realloc(seenIn, 2 * maxURLs * sizeof(int)); assert(seenIn);
+                memset(seenIn + maxURLs, 0, maxURLs * sizeof(int));
+                maxURLs *= 2;
+            }
+            if (++seenIn[id] == needed) settled[nSettled++] = id;                   //URLs settled at the same depth share a median and keep reading order
+        }
     }
-    for (int i = 1; i < listLength + 1; i++) {							//If there is no early return this means the current permutation is better than the bar, therefore is stored as the new bar. O(n)
-        bestRanks[i] = workingRanks[i];									//this should happen extremely infrequently, less than 1% of arrangement in most cases
+    while (nSettled < k && nSettled < nKeys(URLs)) {                                //only reached if every rankfile ran out
+        int best = -1;
+        for (int id = 0; id < nKeys(URLs); id++) {
+            if (seenIn[id] < needed && (best == -1 || seenIn[id] > seenIn[best])) best = id;
+        }
+        settled[nSettled++] = best;
+        seenIn[best] = needed;
     }
-    *barSFD = totalSFD;
-}
\ No newline at end of file
+
+    for (int i = 0; i < nSettled; i++) printf("%s\n", keyOf(URLs, settled[i]));
+    for (int i = 0; i < nFiles; i++) {
+        fprintf(stderr, "%s: read %d lines%s\n", fileNames[i], depthRead[i], fps[i] ? "" : " (whole file)");
+        if (fps[i]) fclose(fps[i]);
+    }
+
+    disposeHashTable(URLs);
+    free(settled); free(depthRead); free(fps); free(seenIn);
+}
@@ -0,0 +1,187 @@
+//Scores for search results: tf-idf for each search term, or the url's pagerank
+//Shared by searchTfIdf, searchPagerank and searchServer, which keeps the index and pageranks loaded between queries
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "URL.h"
+#include "utility.h"
+#include "index.h"
+#include "scores.h"
+
+struct _pageRanks { //every url's pagerank, from the mapped score table by document ID, or else from pagerankList.txt by url
+	double *table;      //points into the mapped SCORE_TABLE, NULL if it isn't being used
+	void *mapped;
+	size_t mappedSize;
+	HashTable ids;      //url -> ID for ranks, when there is no usable table
+	double *ranks;
+};
+
+static int findTfInIndex(URLQueue,char*);
+static int loadScoreTable(PageRanks,Index);
+static void loadPageRankList(PageRanks);
+
+static Index binaryIndex; //the binary index, if there is one, so scores come from its term counts and document lengths without opening any url files
+
+//Scores come from this index from now on, or from the url files and collection.txt if it is NULL
+void setScoringIndex(Index idx) {
+	binaryIndex = idx;
+}
+
+//For each term we receive the urls for that term and calculate the tfidifs for them
+void findTfIdf(URLQueue urlsForTerm, char *searchTerm) {
+	findTf(urlsForTerm, searchTerm);
+	multiplyByIdf(urlsForTerm, urlsForTerm->len);
+}
+
+//calculates the term frequency of  given term in a given URL file.
+void findTf(URLQueue list, char *term) {
+	if (findTfInIndex(list, term)) return;
+	char buffer[MAX_LINE] = {0};
+	for (URLNode mover = list->head; mover; mover = mover->next) {
+		int startRead = 0, numTerms = 0, numWords = 0;
+
+		char *urlFileName = concat(mover->URL, ".txt");
+		FILE *fp = fopen(urlFileName, "r"); assert(fp);		//opens the text file with the URL stored in the URLnode
+		free(urlFileName);
+		while (fgets(buffer, MAX_LINE, fp)) {
+			if (startRead != 1) {
+				if (strEQ(buffer, "#start Section-2\n")) startRead = 1;		//only starts reading at the start of section 2
+				continue;
+			}
+			if (buffer[0] == '#' && buffer[1] == 'e') break;				//finishes at the end of section 2
+
+			char *rest, *token = strtok_r(buffer, " \n", &rest);			//reads all words in part2, keeping track of total read and total of the term in question
+			while (token) {
+				normaliseWord(token);
+				if (strEQ(token, term)) numTerms++;
+				numWords++;		
+			
+				token = strtok_r(NULL, " \n", &rest);
+			}
+		}
+		mover->tf = (double)numTerms/numWords;							//uses this to calculate term frequency
+		fclose(fp);
+	}
+}
+
+/*
+The same term frequencies from the binary index: the term's postings give how many times it is in each URL and
+the document table how many words each URL has. The URLs for a term come in postings order, so one pass over both does it.
+Returns 0 (and leaves the URLs alone) if there is no index or the URLs didn't come from it.
+*/
+static int findTfInIndex(URLQueue list, char *term) {
+	if (!binaryIndex || (list->head && list->head->docID == NOT_FOUND)) return 0;
+	int t = findTerm(binaryIndex, term);
+	if (t == NOT_FOUND) return 1; //then there are no URLs to score either
+	int *docs = malloc(termDocs(binaryIndex, t)*sizeof(int)), *counts = malloc(termDocs(binaryIndex, t)*sizeof(int));
+	assert(docs && counts);
+	int n = getPostings(binaryIndex, t, docs, counts), p = 0;
+	for (URLNode mover = list->head; mover; mover = mover->next) {
+		while (p < n && docs[p] != mover->docID) p++;
+		assert(p < n);
+		mover->tf = (double)counts[p]/docLength(binaryIndex, mover->docID);
+	}
+	free(docs); free(counts);
+	return 1;
+}
+
+//As idf is constant across all files, simply need to find the product of tf and idf for a complete tf-idf score for a URL file
+void multiplyByIdf(URLQueue list, int termURLs) {
+	int totalURLs;
+	if (binaryIndex) totalURLs = nDocs(binaryIndex); //the index knows how many URLs there are, no need to read collection.txt again
+	else {
+		URLQueue urls = getURLS(); 
+		totalURLs = urls->len; freeURLQueue(urls);
+	}
+	for (URLNode mover = list->head; mover; mover = mover->next) {
+		mover->rankScore += mover->tf * log10((double)totalURLs/termURLs);	//tf-idf calculation
+	}
+}
+
+/*
+Loads every url's pagerank: with the binary index, by mapping the score table if there is an up to date one,
+so a result's pagerank is just the table's entry for its document ID. Otherwise from pagerankList.txt by url
+*/
+PageRanks loadPageRanks(Index idx) {
+	PageRanks pr = calloc(1, sizeof(struct _pageRanks)); assert(pr);
+	if (!idx || !loadScoreTable(pr, idx)) loadPageRankList(pr);
+	return pr;
+}
+
+//Goes through the URLQueue and sets the corresponding pagerank for the current URL
+void setPageRanks(PageRanks pr, URLQueue urls) {
+	for (URLNode curr = urls->head; curr; curr = curr->next) {
+		if (pr->table) curr->rankScore = pr->table[curr->docID]; //the urls came from the index the table was checked against
+		else {
+			int id = findID(pr->ids, curr->URL);
+			if (id != NOT_FOUND) curr->rankScore = pr->ranks[id];
+		}
+	}
+}
+
+void freePageRanks(PageRanks pr) {
+	if (pr->mapped) munmap(pr->mapped, pr->mappedSize);
+	if (pr->ids) disposeHashTable(pr->ids);
+	free(pr->ranks);
+	free(pr);
+}
+
+/*
+Maps SCORE_TABLE (written by pagerank) into memory, where it stays until freePageRanks, holding each url's pagerank by its document ID.
+Returns 0 without setting anything if there is no table, collection.txt has changed since it was written (going by its size and
+modification time, so it isn't read again), or it has a different number of documents to the index.
+The table is by place in collection.txt, which is the document ID as long as urls are only added to its end (see updateIndex).
+*/
+static int loadScoreTable(PageRanks pr, Index idx) {
+	int fd = open(SCORE_TABLE, O_RDONLY);
+	if (fd == -1) return 0;
+	struct stat st, collection;
+	void *table = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size >= (off_t)SCORE_TABLE_HEADER) table = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (table == MAP_FAILED) return 0;
+
+	int *header = table;
+	long long *writtenFor = (long long *)(header + 2);
+	int valid = header[0] == SCORE_TABLE_MAGIC && header[1] == docTableSize(idx) && st.st_size == (off_t)(SCORE_TABLE_HEADER + (long)header[1]*sizeof(double))
+	            && stat("collection.txt", &collection) == 0 && writtenFor[0] == collection.st_size
+	            && writtenFor[1] == collection.st_mtim.tv_sec*1000000000LL + collection.st_mtim.tv_nsec;
+	if (!valid) {
+		munmap(table, st.st_size);
+		return 0;
+	}
+	pr->table = (double *)((char *)table + SCORE_TABLE_HEADER);
+	pr->mapped = table;
+	pr->mappedSize = st.st_size;
+	return 1;
+}
+
+//Without a score table, reads pagerankList.txt once into a table of urls
+static void loadPageRankList(PageRanks pr) {
+	char buffer[MAX_LINE], string[MAX_LINE]; double pageRank = 0;
+	FILE *fp = fopen("pagerankList.txt", "r"); assert(fp);
+	HashTable listed = newHashTable(1024);
+	int nRanks = 0, maxRanks = 64;
+	double *pageRanks = malloc(maxRanks*sizeof(double)); assert(pageRanks);
+
+	while (fgets(buffer, MAX_LINE, fp)) {
+		if (sscanf(buffer, "%[^,], %*d, %lf", string, &pageRank) != 2) continue; //from the buffer, read a string stoppping at a "," then find but dont read an int then read a double (all comma-space separated)
+		int id = getID(listed, string);
+		if (id < nRanks) continue; //only the first line for a url counts
+		if (nRanks == maxRanks) {
+			maxRanks *= 2;
+			pageRanks = realloc(pageRanks, maxRanks*sizeof(double)); assert(pageRanks);
+		}
+		pageRanks[nRanks++] = pageRank;
+	}
+	pr->ids = listed;
+	pr->ranks = pageRanks;
+	fclose(fp);
+}
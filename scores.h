@@ -0,0 +1,18 @@
+#ifndef SCORES_H
+#define SCORES_H
+
+#include "URL.h"
+#include "index.h"
+
+typedef struct _pageRanks *PageRanks;
+
+void setScoringIndex(Index);
+void findTfIdf(URLQueue,char*);
+void findTf(URLQueue,char*);
+void multiplyByIdf(URLQueue,int);
+
+PageRanks loadPageRanks(Index);
+void setPageRanks(PageRanks,URLQueue);
+void freePageRanks(PageRanks);
+
+#endif
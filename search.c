@@ -6,112 +6,196 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <assert.h>
-#include "set.h"
 #include "URL.h"
 #include "search.h"
 #include "utility.h"
+#include "index.h"
 
-static void incrementTotalTermMatches(char*,URLQueue);
-static void copyChanges(URLQueue,URLQueue);
-static int compareFunction(const void*,const void*);
+typedef struct _matches {  //the urls a query has matched so far, found by ID rather than by comparing urls
+	URLQueue all;             //the master queue, in the order the urls were first matched
+	URLNode *byID;            //byID[id] is the master queue's node for the url with that ID, NULL until it is matched
+	int maxIDs;
+	HashTable collection;     //url -> place in collection.txt, the IDs for invertedIndex.txt, which has no document IDs; NULL with the binary index
+	URLNode *forTerm;         //forTerm[i] is the master queue's node for the current term's i-th url
+	int nForTerm, maxForTerm;
+} Matches;
+
+typedef struct _ranked {   //a matched url and its place in the master queue, which breaks ties
+	URLNode node;
+	int order;
+} Ranked;
+
+static void addMatch(Matches*,char*,int,int,URLQueue);
+static void findTermInText(FILE*,char*,Matches*,URLQueue);
+static void findTermInIndex(Index,char*,Matches*,URLQueue);
+static void siftDown(Ranked*,int,Ranked);
+static int rankedBefore(Ranked*,Ranked*);
 
 /*************************************************************************
 for each search term
-	go through inverted index and find the line with that term
-	add all the urls to a queue for the current term
+	find the urls with that term, from the binary index if the caller has one open (a dictionary search and one postings list
+	per term, rather than a scan of the whole text index), otherwise from invertedIndex.txt
+	add all the urls to a queue for the current term, carrying over the scores they have so far
 	if a url is in the master queue (for all search terms):
 		increment its matches
 	else:
 		add it to the master queue and set matches to 1
 	
-	copy the data from the master queue into the term's queue
 	call the given function if not null with the term given its relevant queue
 	copy any changes that function may have made to the term's queue into the master queue
+
+Urls are looked up by document ID (or for invertedIndex.txt, their place in collection.txt, found by hashing) in an array of the
+master queue's nodes, and each term remembers its urls' master nodes in order, so once a term's postings (or line) have been found
+the term costs time in proportion to them
 *************************************************************************/
-URLQueue getURLsWithSearchTerms(int argc, char *argv[], void (*functionForSearchTerm) (URLQueue URLsForTerm, char *searchTerm)) {
-	URLQueue URLsWithSearchTerms = newURLQueue(); //the master queue which will hold all URLs found for all search terms
-	Set seenURLs = newSet();
-	FILE *fp = fopen("invertedIndex.txt", "r"); assert(fp);
+URLQueue getURLsWithSearchTerms(Index binaryIndex, int argc, char *argv[], void (*functionForSearchTerm) (URLQueue URLsForTerm, char *searchTerm)) {
+	Matches matches = { .all = newURLQueue(), .collection = NULL, .nForTerm = 0, .maxForTerm = 64 }; //all is the master queue which will hold all URLs found for all search terms
+	FILE *fp = NULL;
+	if (binaryIndex) matches.maxIDs = docTableSize(binaryIndex);
+	else {
+		fp = fopen("invertedIndex.txt", "r"); assert(fp);
+		URLQueue urls = getURLS(); //read once, to tell the urls on a line of invertedIndex.txt from the words
+		matches.collection = getURLIDs(urls);
+		matches.maxIDs = urls->len;
+		freeURLQueue(urls);
+	}
+	matches.byID = calloc(matches.maxIDs > 0 ? matches.maxIDs : 1, sizeof(URLNode));
+	matches.forTerm = malloc(matches.maxForTerm*sizeof(URLNode));
+	assert(matches.byID && matches.forTerm);
 
 	for (int i = 1; i < argc; i++) {
 		URLQueue URLsForTerm = newURLQueue(); //a queue that should the urls for the current search term
-		int found = 0; char string[MAX_LINE]; //needs to handle both words and urls
+		matches.nForTerm = 0;
 
 		normaliseWord(argv[i]); //normalise the search term as the terms in invertedIndex.txt are normalised
-		while (fscanf(fp, "%s", string) == 1) {
-			if (found) {
-				if (isURL(string)) { //then we're on the line with the search term
-					newURLNode(string, URLsForTerm); //can insert without checking because urls are unique on a line in invertedIndex.txt
-					if (!isElem(seenURLs, string)) { //so that we dont get duplicates in the master queue
-						newURLNode(string, URLsWithSearchTerms);
-						URLsWithSearchTerms->tail->termMatches = 1;
-						insertInto(seenURLs, string);
-					}
-					else incrementTotalTermMatches(string, URLsWithSearchTerms);
-				}
-				else break; //then we've moved to the next line and we have finished reading the relevant line
-			}
-			else if (strEQ(string, argv[i])) found = 1; //we havent found the search term line yet but we may find it now
-		}
+		if (binaryIndex) findTermInIndex(binaryIndex, argv[i], &matches, URLsForTerm);
+		else findTermInText(fp, argv[i], &matches, URLsForTerm);
 
-		copyChanges(URLsWithSearchTerms, URLsForTerm); //so that we can keep the rankScore for aggregation
 		if (functionForSearchTerm) functionForSearchTerm(URLsForTerm, argv[i]);
-		copyChanges(URLsForTerm, URLsWithSearchTerms); //so that our final list that gets sorted has the updated values after calculations
+		int n = 0;
+		for (URLNode curr = URLsForTerm->head; curr; curr = curr->next) { //so that our final list that gets sorted has the updated values after calculations
+			URLNode master = matches.forTerm[n++];
+			master->tf = curr->tf;
+			master->rankScore = curr->rankScore;
+		}
 		
-		if (i+1 != argc) rewind(fp); //we only need to rewind the file pointer if it's not the last iteration
 		freeURLQueue(URLsForTerm);
 	}
 
-	fclose(fp);
-	disposeSet(seenURLs);
-	return URLsWithSearchTerms;
+	if (fp) fclose(fp);
+	if (matches.collection) disposeHashTable(matches.collection);
+	free(matches.byID); free(matches.forTerm);
+	return matches.all;
 }
 
-//Go through the URLQueue until you find the node with the matching url, then increment its matches
-static void incrementTotalTermMatches(char *url, URLQueue urls) {
-	URLNode curr = urls->head;
-	while (!strEQ(curr->URL, url)) curr = curr->next;
-	curr->termMatches += 1;
+/*
+Adds a url with the current term to the term's queue, with the scores it has so far so they can be aggregated,
+and to the master queue if it's not already there (otherwise increments its matches).
+id is what the url is found by in byID (less than maxIDs), docID its document ID if it came from the binary index
+*/
+static void addMatch(Matches *matches, char *url, int id, int docID, URLQueue URLsForTerm) {
+	URLNode master = matches->byID[id];
+	if (!master) { //so that we dont get duplicates in the master queue
+		newURLNode(url, matches->all);
+		master = matches->byID[id] = matches->all->tail;
+		master->termMatches = 1;
+		master->docID = docID;
+	}
+	else master->termMatches += 1;
+
+	newURLNode(url, URLsForTerm); //can insert without checking because urls are unique for a term
+	URLsForTerm->tail->docID = docID;
+	URLsForTerm->tail->tf = master->tf;
+	URLsForTerm->tail->rankScore = master->rankScore;
+	if (matches->nForTerm == matches->maxForTerm) {
+		matches->maxForTerm *= 2;
+		matches->forTerm = realloc(matches->forTerm, matches->maxForTerm*sizeof(URLNode)); assert(matches->forTerm);
+	}
+	matches->forTerm[matches->nForTerm++] = master;
 }
 
-//Go through the nodes in the newQ, find the matching node in the oldQ if it exists and copy over the data
-static void copyChanges(URLQueue newQ, URLQueue oldQ) {
-	for (URLNode currForNew = newQ->head; currForNew; currForNew = currForNew->next) {
-		URLNode currForOld = oldQ->head;
-		while (currForOld && !strEQ(currForOld->URL, currForNew->URL)) currForOld = currForOld->next;
-		if (currForOld) {
-			//keep oldQ updated except for termMatches because this is maintained in the calling function
-			currForOld->tf = currForNew->tf;
-			currForOld->rankScore = currForNew->rankScore;
+//Goes through invertedIndex.txt from the start and finds the line with the term
+static void findTermInText(FILE *fp, char *term, Matches *matches, URLQueue URLsForTerm) {
+	int found = 0; char string[MAX_LINE]; //needs to handle both words and urls
+	rewind(fp);
+	while (fscanf(fp, "%s", string) == 1) {
+		if (found) {
+			int id = findID(matches->collection, string);
+			if (id != NOT_FOUND) addMatch(matches, string, id, NOT_FOUND, URLsForTerm); //then we're on the line with the search term
+			else break; //then we've moved to the next line and we have finished reading the relevant line
 		}
+		else if (strEQ(string, term)) found = 1; //we havent found the search term line yet but we may find it now
 	}
 }
 
-//Populate an array with the pointers to the nodes in the URLQueue, then quicksort this array and return the sorted array
-URLNode * sortResults(URLQueue urls) {
- 	int index = 0;
-	URLNode *nodePointersArray = calloc(urls->len, sizeof(URLNode)); assert(nodePointersArray);
-	for (URLNode curr = urls->head; curr; curr = curr->next) nodePointersArray[index++] = curr;
-	
-	qsort(nodePointersArray, urls->len, sizeof(URLNode), compareFunction);
+//Looks the term up in the binary index and decodes its postings, which are in the same (collection) order as the urls in invertedIndex.txt
+static void findTermInIndex(Index binaryIndex, char *term, Matches *matches, URLQueue URLsForTerm) {
+	int t = term[0] ? findTerm(binaryIndex, term) : NOT_FOUND; //an empty term (a search term with no letters) never matches a line of the text index either
+	if (t == NOT_FOUND) return;
+	int *docs = malloc((termDocs(binaryIndex, t) > 0 ? termDocs(binaryIndex, t) : 1)*sizeof(int)); assert(docs);
+	int n = getPostings(binaryIndex, t, docs, NULL);
+	for (int d = 0; d < n; d++) addMatch(matches, docURL(binaryIndex, docs[d]), docs[d], docs[d], URLsForTerm);
+	free(docs);
+}
+
+/*
+Keeps the best k urls seen so far in a heap with the worst of them on top, so each url after the first k costs
+one comparison with the top (and log k to replace it if it's better), then sorts just those k.
+Sets k to how many there are (fewer if fewer urls matched) and returns the array of them, best first
+*/
+URLNode * sortResults(URLQueue urls, int *k) {
+	int size = 0, order = 0;
+	if (*k > urls->len) *k = urls->len;
+	if (*k < 0) *k = 0;
+	Ranked *heap = malloc((*k > 0 ? *k : 1)*sizeof(Ranked)); assert(heap);
+	for (URLNode curr = urls->head; curr && *k > 0; curr = curr->next) {
+		Ranked r = { curr, order++ };
+		if (size < *k) { //sift it up from the bottom
+			int i = size++;
+			while (i > 0 && rankedBefore(&heap[(i-1)/2], &r)) {
+				heap[i] = heap[(i-1)/2];
+				i = (i-1)/2;
+			}
+			heap[i] = r;
+		}
+		else if (rankedBefore(&r, &heap[0])) siftDown(heap, size, r);
+	}
+	URLNode *nodePointersArray = malloc((*k > 0 ? *k : 1)*sizeof(URLNode)); assert(nodePointersArray);
+	for (int i = size - 1; i >= 0; i--) { //taking the worst off the top each time fills the array from the back
+		nodePointersArray[i] = heap[0].node;
+		siftDown(heap, i, heap[i]);
+	}
+	free(heap);
 	return nodePointersArray;
 }
 
-//Compare two pointers to pointers to URLNodes and sort them based on termMatches and then rankScore if needed
-static int compareFunction(const void *element1, const void *element2) {
-	URLNode node1 = *((URLNode *)element1); URLNode node2 = *((URLNode *)element2); //our elements were URLNode so we've been passed pointers to URLNode
+//Puts r at the top of the heap of size and moves it down until it comes before neither child
+static void siftDown(Ranked *heap, int size, Ranked r) {
+	int i = 0;
+	while (2*i + 1 < size) {
+		int child = 2*i + 1;
+		if (child + 1 < size && rankedBefore(&heap[child], &heap[child+1])) child++; //the worse child
+		if (!rankedBefore(&r, &heap[child])) break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	heap[i] = r;
+}
+
+//Whether a comes before b in the results: on termMatches and then rankScore if needed, as they were always sorted, and then whichever matched first
+static int rankedBefore(Ranked *a, Ranked *b) {
+	URLNode node1 = a->node, node2 = b->node;
 	//compare on the primary sorting field
 	double comparison = node2->termMatches - node1->termMatches;
-	if (comparison > 0) return 1;
-	if (comparison < 0) return -1;
+	if (comparison != 0) return comparison < 0;
 	//compare on the secondary sorting field because the primary sorting field is equal
 	comparison = node2->rankScore - node1->rankScore;
-	if (comparison > 0) return 1;
-	if (comparison < 0) return -1;
-	return 0;
+	if (comparison > 0) return 0;
+	if (comparison < 0) return 1;
+	return a->order < b->order;
 }
 
-//Go through the nodePointers array and print the top 30 or less results with the given print function 
+//Go through the nodePointers array and print the results (the top MAX_PRINT or less, as sortResults is usually asked for) with the given print function 
 void outputResults(URLNode * nodePointers, int size, void (*printFp) (URLNode urlNode)) {
-	for (int i = 0; i < (size > MAX_PRINT ? MAX_PRINT : size); i++) printFp(nodePointers[i]);
+	for (int i = 0; i < size; i++) printFp(nodePointers[i]);
 }
\ No newline at end of file
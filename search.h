@@ -2,10 +2,12 @@
 #define SEARCH_H
 
 #include "URL.h"
-#define MAX_PRINT 30
+#include "index.h"
+#define MAX_PRINT 30 //how many results are printed unless asked for more or less
+#define SEARCH_SOCKET "searchServer.sock" //where searchServer -s listens and searchClient connects by default
 
-URLQueue getURLsWithSearchTerms(int,char*[],void(*)(URLQueue,char*));
-URLNode *sortResults(URLQueue);
+URLQueue getURLsWithSearchTerms(Index,int,char*[],void(*)(URLQueue,char*));
+URLNode *sortResults(URLQueue,int*);
 void outputResults(URLNode*,int,void(*)(URLNode));
 
 #endif
\ No newline at end of file
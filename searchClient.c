@@ -0,0 +1,66 @@
+//A thin client for searchServer -s, for scripts that run a lot of searches
+//Sends its arguments as one query and prints the answer just as searchTfIdf or searchPagerank would,
+//or with no query, passes query lines from stdin through and prints each answer followed by an empty line
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "URL.h"
+#include "search.h"
+
+int connectTo(char*);
+
+int main(int argc, char *argv[]) {
+	char *socketFile = SEARCH_SOCKET;
+	int first = 1;
+	if (argc >= 3 && strEQ(argv[1], "-s")) { //-s <socket> if the server isn't listening on the default one
+		socketFile = argv[2];
+		first = 3;
+	}
+	if (first == argc - 1 || (first < argc && !strEQ(argv[first], "tfidf") && !strEQ(argv[first], "pagerank"))) {
+		fprintf(stderr, "Usage: [-s <socket>] [tfidf|pagerank <searchTerm> <searchTerm> ...]\n");
+		return 1;
+	}
+	int server = connectTo(socketFile);
+	FILE *out = fdopen(server, "w"), *in = fdopen(dup(server), "r");
+	assert(out && in);
+
+	char *line = NULL; size_t size = 0;
+	if (first < argc) {
+		for (int i = first; i < argc; i++) fprintf(out, "%s%c", argv[i], i == argc - 1 ? '\n' : ' ');
+		fflush(out);
+		shutdown(server, SHUT_WR);
+		while (getline(&line, &size, in) != -1 && !strEQ(line, "\n")) fputs(line, stdout); //the empty line ends the answer
+	}
+	else {
+		while (getline(&line, &size, stdin) != -1) {
+			fputs(line, out);
+			if (line[strlen(line)-1] != '\n') fputc('\n', out);
+			fflush(out);
+			while (getline(&line, &size, in) != -1) {
+				fputs(line, stdout);
+				if (strEQ(line, "\n")) break;
+			}
+		}
+	}
+	free(line);
+	fclose(out); fclose(in);
+	return 0;
+}
+
+//Connects to the server's socket, or exits if it isn't running
+int connectTo(char *fileName) {
+	struct sockaddr_un address = { .sun_family = AF_UNIX };
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	assert(server != -1 && strlen(fileName) < sizeof(address.sun_path));
+	strcpy(address.sun_path, fileName);
+	if (connect(server, (struct sockaddr *)&address, sizeof(address)) != 0) {
+		perror(fileName);
+		exit(1);
+	}
+	return server;
+}
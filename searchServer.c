@@ -0,0 +1,245 @@
+//A search server that keeps the index and pageranks loaded, so a query only costs looking up and scoring its own terms
+//Queries are lines of "tfidf|pagerank <searchTerm> <searchTerm> ..." read from stdin, or from clients on a unix socket with -s,
+//and each is answered with exactly what searchTfIdf or searchPagerank would print for it, then an empty line.
+//With -b a file of such queries is answered in one go by a pool of threads sharing the loaded index, in the file's order
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "URL.h"
+#include "search.h"
+#include "index.h"
+#include "scores.h"
+
+#define MAX_QUEUED 16 //clients waiting to connect
+
+typedef struct _batch {   //a file of queries being answered by a pool of threads
+	char **queries;
+	int nQueries;
+	char **answers;       //answers[q] is what query q printed, kept until the queries before it have been written out
+	size_t *sizes;
+	char *answered;
+	pthread_mutex_t lock;
+	int nextQuery;        //the next query for a thread to take
+	int nWritten;         //answers 0 .. nWritten-1 have gone to stdout
+} Batch;
+
+void refresh();
+void answer(char*,FILE*);
+void serve(char*);
+void answerBatch(char*,int);
+void *batchThread(void*);
+void printTfIdf(URLNode);
+void printPageRank(URLNode);
+static void stop(int);
+
+static Index binaryIndex;     //NULL if there is only invertedIndex.txt
+static PageRanks pageRanks;
+static long long loadedFrom[4]; //when each file that was loaded last changed (in ns), to notice inverted or pagerank running again
+static __thread FILE *replyTo; //where the print functions write the answer to this thread's query
+static char *socketFile;
+static int nResults = MAX_PRINT; //printed for each query
+
+int main(int argc, char *argv[]) {
+	char *batchFile = NULL;
+	int nThreads = 0, badOption = 0;
+	for (int i = 1; i < argc && !badOption; i++) {
+		if (strEQ(argv[i], "-s")) socketFile = i+1 < argc && argv[i+1][0] != '-' ? argv[++i] : SEARCH_SOCKET; //-s [<socket>] takes queries from clients on a unix socket
+		else if (strEQ(argv[i], "-b") && i+1 < argc) batchFile = argv[++i]; //-b <queries> answers a file of queries
+		else if (strEQ(argv[i], "-t") && i+1 < argc) nThreads = atoi(argv[++i]); //-t <threads> answers them with that many threads rather than one per core
+		else if (strEQ(argv[i], "-k") && i+1 < argc) nResults = atoi(argv[++i]); //-k <results> prints that many results per query rather than MAX_PRINT
+		else badOption = 1;
+	}
+	if (badOption || (socketFile && batchFile) || (nThreads && !batchFile)) {
+		fprintf(stderr, "Usage: [-s [<socket>] | -b <queryFile> [-t <threads>]] [-k <results>]\n");
+		return 1;
+	}
+	if (nThreads <= 0) nThreads = sysconf(_SC_NPROCESSORS_ONLN);
+	refresh();
+	if (socketFile) serve(socketFile);
+	else if (batchFile) answerBatch(batchFile, nThreads > 0 ? nThreads : 1);
+	else {
+		char *line = NULL; size_t size = 0;
+		while (getline(&line, &size, stdin) != -1) {
+			refresh();
+			answer(line, stdout);
+		}
+		free(line);
+	}
+	if (binaryIndex) closeIndex(binaryIndex);
+	freePageRanks(pageRanks);
+	return 0;
+}
+
+//(Re)loads the index and pageranks if they have never been loaded or inverted or pagerank has rewritten them since
+void refresh() {
+	char *files[4] = { INDEX_MANIFEST, INDEX_FILE, SCORE_TABLE, "pagerankList.txt" };
+	long long changed[4];
+	int same = pageRanks != NULL;
+	for (int f = 0; f < 4; f++) {
+		struct stat st;
+		changed[f] = stat(files[f], &st) == 0 ? st.st_mtim.tv_sec*1000000000LL + st.st_mtim.tv_nsec : 0;
+		same = same && changed[f] == loadedFrom[f];
+	}
+	if (same) return;
+	if (binaryIndex) closeIndex(binaryIndex);
+	if (pageRanks) freePageRanks(pageRanks);
+	binaryIndex = openCurrentIndex();
+	setScoringIndex(binaryIndex);
+	pageRanks = loadPageRanks(binaryIndex);
+	memcpy(loadedFrom, changed, sizeof(changed));
+}
+
+/*
+Answers one query line: the words are split out as if they were searchTfIdf's or searchPagerank's arguments (with the
+mode in place of the program name) and go through the same search, scoring and printing.
+Only reads the index and pageranks, so several threads can answer queries at once
+*/
+void answer(char *line, FILE *out) {
+	int nWords = 0, maxWords = 8;
+	char **words = malloc(maxWords*sizeof(char*)), *rest;
+	assert(words);
+	for (char *word = strtok_r(line, " \t\r\n", &rest); word; word = strtok_r(NULL, " \t\r\n", &rest)) {
+		if (nWords == maxWords) {
+			maxWords *= 2;
+			words = realloc(words, maxWords*sizeof(char*)); assert(words);
+		}
+		words[nWords++] = word;
+	}
+	int tfIdf = nWords > 0 && strEQ(words[0], "tfidf");
+	if (nWords < 2 || (!tfIdf && !strEQ(words[0], "pagerank"))) fprintf(out, "Usage: tfidf|pagerank <searchTerm> <searchTerm> ...\n");
+	else {
+		URLQueue URLsWithSearchTerms = getURLsWithSearchTerms(binaryIndex, nWords, words, tfIdf ? findTfIdf : NULL);
+		if (!tfIdf) setPageRanks(pageRanks, URLsWithSearchTerms);
+		int k = nResults;
+		URLNode *sortedNodePointersArray = sortResults(URLsWithSearchTerms, &k);
+		replyTo = out;
+		outputResults(sortedNodePointersArray, k, tfIdf ? printTfIdf : printPageRank);
+		free(sortedNodePointersArray);
+		freeURLQueue(URLsWithSearchTerms);
+	}
+	fprintf(out, "\n");
+	fflush(out);
+	free(words);
+}
+
+//Listens on a unix socket and answers every query line a client sends until it closes its end, one client at a time
+void serve(char *fileName) {
+	struct sockaddr_un address = { .sun_family = AF_UNIX };
+	assert(strlen(fileName) < sizeof(address.sun_path));
+	strcpy(address.sun_path, fileName);
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	assert(listener != -1);
+	unlink(fileName); //left behind by a server that didn't get to clean up
+	if (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listener, MAX_QUEUED) != 0) {
+		perror(fileName);
+		exit(1);
+	}
+	signal(SIGPIPE, SIG_IGN); //a client that hangs up early only loses its own answer
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+	while (1) {
+		int client = accept(listener, NULL, NULL);
+		if (client == -1) continue;
+		FILE *in = fdopen(client, "r"), *out = fdopen(dup(client), "w");
+		assert(in && out);
+		char *line = NULL; size_t size = 0;
+		while (getline(&line, &size, in) != -1) {
+			refresh();
+			answer(line, out);
+		}
+		free(line);
+		fclose(in); fclose(out);
+	}
+}
+
+/*
+Reads every query in the file, then a pool of threads takes them one at a time and answers each into memory.
+Whichever thread finishes the query the output is waiting on writes it out, along with any after it that are already done,
+so stdout is the same as feeding the file to the server on stdin and answers don't pile up behind a slow query for long.
+The index and pageranks are loaded once and not refreshed part way through
+*/
+void answerBatch(char *fileName, int nThreads) {
+	FILE *fp = fopen(fileName, "r");
+	if (!fp) {
+		perror(fileName);
+		exit(1);
+	}
+	Batch batch = { .nQueries = 0, .nextQuery = 0, .nWritten = 0 };
+	int maxQueries = 64;
+	batch.queries = malloc(maxQueries*sizeof(char*)); assert(batch.queries);
+	char *line = NULL; size_t size = 0;
+	while (getline(&line, &size, fp) != -1) {
+		if (batch.nQueries == maxQueries) {
+			maxQueries *= 2;
+			batch.queries = realloc(batch.queries, maxQueries*sizeof(char*)); assert(batch.queries);
+		}
+		batch.queries[batch.nQueries++] = line;
+		line = NULL; size = 0;
+	}
+	free(line);
+	fclose(fp);
+
+	batch.answers = malloc((batch.nQueries > 0 ? batch.nQueries : 1)*sizeof(char*));
+	batch.sizes = malloc((batch.nQueries > 0 ? batch.nQueries : 1)*sizeof(size_t));
+	batch.answered = calloc(batch.nQueries > 0 ? batch.nQueries : 1, 1);
+	pthread_t *threads = malloc(nThreads*sizeof(pthread_t));
+	assert(batch.answers && batch.sizes && batch.answered && threads);
+	pthread_mutex_init(&batch.lock, NULL);
+	for (int t = 1; t < nThreads; t++) pthread_create(&threads[t], NULL, batchThread, &batch);
+	batchThread(&batch);
+	for (int t = 1; t < nThreads; t++) pthread_join(threads[t], NULL);
+	pthread_mutex_destroy(&batch.lock);
+
+	fflush(stdout);
+	for (int q = 0; q < batch.nQueries; q++) free(batch.queries[q]);
+	free(batch.queries); free(batch.answers); free(batch.sizes); free(batch.answered); free(threads);
+}
+
+//Keeps taking the next query and answering it until there are none left, writing out the answers that are next in order
+void *batchThread(void *arg) {
+	Batch *batch = arg;
+	while (1) {
+		pthread_mutex_lock(&batch->lock);
+		int q = batch->nextQuery++;
+		pthread_mutex_unlock(&batch->lock);
+		if (q >= batch->nQueries) break;
+		FILE *out = open_memstream(&batch->answers[q], &batch->sizes[q]);
+		assert(out);
+		answer(batch->queries[q], out);
+		fclose(out);
+
+		pthread_mutex_lock(&batch->lock);
+		batch->answered[q] = 1;
+		for (; batch->nWritten < batch->nQueries && batch->answered[batch->nWritten]; batch->nWritten++) {
+			fwrite(batch->answers[batch->nWritten], 1, batch->sizes[batch->nWritten], stdout);
+			free(batch->answers[batch->nWritten]);
+		}
+		pthread_mutex_unlock(&batch->lock);
+	}
+	return NULL;
+}
+
+//Removes the socket when the server is stopped
+static void stop(int signal) {
+	(void)signal;
+	unlink(socketFile);
+	_exit(0);
+}
+
+//Print tf-idf score, as searchTfIdf does
+void printTfIdf(URLNode urlNode) {
+	fprintf(replyTo, "%s %.6lf\n", urlNode->URL, urlNode->rankScore);
+}
+
+//Print the url, as searchPagerank does
+void printPageRank(URLNode urlNode) {
+	fprintf(replyTo, "%s\n", urlNode->URL);
+}
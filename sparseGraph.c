@@ -0,0 +1,179 @@
+// sparseGraph.c ... directed Graph of strings (compressed sparse rows)
+// Built once from an edge list; both the out-edges and the in-edges of every vertex are stored contiguously
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include "sparseGraph.h"
+
+// Function signatures
+
+SparseGraph newSparseGraph(HashTable,int,int *,int *);
+void  disposeSparseGraph(SparseGraph);
+char *vertexName(SparseGraph,int);
+int   outDegree(SparseGraph,int);
+int   inDegree(SparseGraph,int);
+int   hasEdge(SparseGraph,int,int);
+int   saveSparseGraph(SparseGraph,FILE *);
+SparseGraph loadSparseGraph(FILE *);
+
+static int compareIDs(const void *, const void *);
+
+
+// newSparseGraph(Names,nE,Src,Dest)
+// - create a Graph with a vertex for every ID in Names and an edge Src[i]->Dest[i] for each i < nE
+// - duplicate edges are kept once; the Graph takes ownership of Names
+SparseGraph newSparseGraph(HashTable names, int nE, int *src, int *dest)
+{
+	SparseGraph new = malloc(sizeof(SparseGraphRep));
+	assert(new != NULL);
+	int nV = nKeys(names);
+	new->nV = nV;
+	new->names = names;
+	new->outStart = calloc(nV+1, sizeof(int));
+	new->inStart = calloc(nV+1, sizeof(int));
+	int *outEdges = malloc((nE > 0 ? nE : 1)*sizeof(int));
+	assert(new->outStart != NULL && new->inStart != NULL && outEdges != NULL);
+
+	// counting sort the edges by source
+	for (int e = 0; e < nE; e++) new->outStart[src[e]+1]++;
+	for (int v = 0; v < nV; v++) new->outStart[v+1] += new->outStart[v];
+	int *fill = malloc((nV > 0 ? nV : 1)*sizeof(int));
+	assert(fill != NULL);
+	memcpy(fill, new->outStart, nV*sizeof(int));
+	for (int e = 0; e < nE; e++) outEdges[fill[src[e]]++] = dest[e];
+
+	// sort each row and squeeze out duplicates
+	int kept = 0;
+	for (int v = 0; v < nV; v++) {
+		int start = new->outStart[v], end = new->outStart[v+1];
+		qsort(outEdges+start, end-start, sizeof(int), compareIDs);
+		new->outStart[v] = kept;
+		for (int e = start; e < end; e++) {
+			if (e == start || outEdges[e] != outEdges[e-1]) outEdges[kept++] = outEdges[e];
+		}
+	}
+	new->outStart[nV] = kept;
+	new->nE = kept;
+	new->outEdges = realloc(outEdges, (kept > 0 ? kept : 1)*sizeof(int));
+	new->inEdges = malloc((kept > 0 ? kept : 1)*sizeof(int));
+	assert(new->outEdges != NULL && new->inEdges != NULL);
+
+	// in-edges by counting sort on destination; sources are visited in order so each row comes out sorted
+	for (int e = 0; e < kept; e++) new->inStart[new->outEdges[e]+1]++;
+	for (int v = 0; v < nV; v++) new->inStart[v+1] += new->inStart[v];
+	memcpy(fill, new->inStart, nV*sizeof(int));
+	for (int v = 0; v < nV; v++) {
+		for (int e = new->outStart[v]; e < new->outStart[v+1]; e++) new->inEdges[fill[new->outEdges[e]]++] = v;
+	}
+	free(fill);
+	return new;
+}
+
+// disposeSparseGraph(Graph)
+// - clean up memory associated with Graph
+void disposeSparseGraph(SparseGraph g)
+{
+	if (g == NULL) return;
+	disposeHashTable(g->names);
+	free(g->outStart);
+	free(g->outEdges);
+	free(g->inStart);
+	free(g->inEdges);
+	free(g);
+}
+
+// vertexName(Graph,V)
+// - return the name of vertex V
+char *vertexName(SparseGraph g, int v)
+{
+	assert(g != NULL);
+	return keyOf(g->names, v);
+}
+
+// outDegree(Graph,V)
+// - return # edges leaving V
+int outDegree(SparseGraph g, int v)
+{
+	assert(g != NULL);
+	return g->outStart[v+1] - g->outStart[v];
+}
+
+// inDegree(Graph,V)
+// - return # edges entering V
+int inDegree(SparseGraph g, int v)
+{
+	assert(g != NULL);
+	return g->inStart[v+1] - g->inStart[v];
+}
+
+// hasEdge(Graph,Src,Dest)
+// - check whether there is an edge from Src->Dest (binary search of Src's out-edges)
+int hasEdge(SparseGraph g, int v, int w)
+{
+	assert(g != NULL);
+	int lo = g->outStart[v], hi = g->outStart[v+1];
+	while (lo < hi) {
+		int mid = (lo + hi)/2;
+		if (g->outEdges[mid] == w) return 1;
+		if (g->outEdges[mid] < w) lo = mid + 1;
+		else hi = mid;
+	}
+	return 0;
+}
+
+// saveSparseGraph(Graph,File)
+// - write Graph to an open binary file: nV, nE, each vertex name (length then bytes), then the out-edge rows
+// - returns 1 if every write went through, 0 if any fell short (e.g. the disk is full)
+int saveSparseGraph(SparseGraph g, FILE *fp)
+{
+	assert(g != NULL && fp != NULL);
+	int ok = fwrite(&g->nV, sizeof(int), 1, fp) == 1 && fwrite(&g->nE, sizeof(int), 1, fp) == 1;
+	for (int v = 0; v < g->nV && ok; v++) {
+		int len = strlen(vertexName(g, v));
+		ok = fwrite(&len, sizeof(int), 1, fp) == 1 && fwrite(vertexName(g, v), 1, len, fp) == (size_t)len;
+	}
+	return ok && fwrite(g->outStart, sizeof(int), g->nV+1, fp) == (size_t)g->nV+1 && fwrite(g->outEdges, sizeof(int), g->nE, fp) == (size_t)g->nE;
+}
+
+// loadSparseGraph(File)
+// - read back a Graph written by saveSparseGraph, with the same vertex IDs
+// - returns NULL if the file is cut short
+SparseGraph loadSparseGraph(FILE *fp)
+{
+	assert(fp != NULL);
+	int nV, nE, len;
+	if (fread(&nV, sizeof(int), 1, fp) != 1 || fread(&nE, sizeof(int), 1, fp) != 1 || nV < 0 || nE < 0) return NULL;
+	HashTable names = newHashTable(nV);
+	char *name = NULL;
+	for (int v = 0; v < nV; v++) {
+		if (fread(&len, sizeof(int), 1, fp) != 1 || len < 0 || (name = realloc(name, len+1)) == NULL || fread(name, 1, len, fp) != (size_t)len) {
+			free(name); disposeHashTable(names);
+			return NULL;
+		}
+		name[len] = '\0';
+		getID(names, name);
+	}
+	free(name);
+	int *outStart = malloc((nV+1)*sizeof(int)), *src = malloc((nE > 0 ? nE : 1)*sizeof(int)), *dest = malloc((nE > 0 ? nE : 1)*sizeof(int));
+	assert(outStart != NULL && src != NULL && dest != NULL);
+	SparseGraph g = NULL;
+	if (fread(outStart, sizeof(int), nV+1, fp) == (size_t)nV+1 && fread(dest, sizeof(int), nE, fp) == (size_t)nE) {
+		for (int v = 0; v < nV; v++) {
+			for (int e = outStart[v]; e < outStart[v+1]; e++) src[e] = v;
+		}
+		g = newSparseGraph(names, nE, src, dest);
+	}
+	else disposeHashTable(names);
+	free(outStart); free(src); free(dest);
+	return g;
+}
+
+// Helper functions
+
+static int compareIDs(const void *a, const void *b)
+{
+	int x = *(int *)a, y = *(int *)b;
+	return (x > y) - (x < y);
+}
@@ -0,0 +1,33 @@
+// sparseGraph.h ... interface to directed Graph of strings (compressed sparse rows)
+// Vertices are dense integer IDs, with names kept in a HashTable, so memory is O(V+E) rather than O(V^2)
+
+#ifndef SPARSEGRAPH_H
+#define SPARSEGRAPH_H
+
+#include <stdio.h>
+#include "hashTable.h"
+
+typedef struct SparseGraphRep *SparseGraph;
+
+typedef struct SparseGraphRep {
+	int   nV;
+	int   nE;
+	HashTable names;  // vertex name <-> vertex ID
+	int   *outStart;  // out-edges of v are outEdges[outStart[v]] .. outEdges[outStart[v+1]-1], in increasing ID order
+	int   *outEdges;
+	int   *inStart;   // in-edges of v are inEdges[inStart[v]] .. inEdges[inStart[v+1]-1], in increasing ID order
+	int   *inEdges;
+} SparseGraphRep;
+
+// Function signatures
+
+SparseGraph newSparseGraph(HashTable,int,int *,int *);
+void  disposeSparseGraph(SparseGraph);
+char *vertexName(SparseGraph,int);
+int   outDegree(SparseGraph,int);
+int   inDegree(SparseGraph,int);
+int   hasEdge(SparseGraph,int,int);
+int   saveSparseGraph(SparseGraph,FILE *);
+SparseGraph loadSparseGraph(FILE *);
+
+#endif